@@ -0,0 +1,84 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * bufferpool.h -- fixed-size recycling pool of track buffers
+ */
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <QByteArray>
+
+#include <vector>
+
+/*
+ * A fixed set of track-sized QByteArrays recycled instead of
+ * reallocated, so steady-state serving (WRIT capture, cache fills)
+ * performs no heap allocations and RSS stays flat over long sessions.
+ *
+ * acquire() hands out a slot whose storage is preallocated; the caller
+ * fills it through data(), takes however many shallow QByteArray copies
+ * it needs (journal entry, cache entry, ...), then calls publish().
+ * The slot stays out of circulation while any of those copies is alive
+ * -- Qt's shared-data refcount is the occupancy test, checked with
+ * isDetached() -- and returns to the pool by itself once the last
+ * holder lets go.  No locks: the refcount probe is atomic, and
+ * acquire()/publish() callers are expected to serialize themselves
+ * (a single engine thread, or an already-held cache lock).
+ *
+ * When every slot is in use acquire() returns null and the caller
+ * falls back to a plain allocation; the pool is a fast path, not a
+ * correctness requirement.
+ */
+class BufferPool
+{
+public:
+    BufferPool(int slots, int size)
+        : m_slots(slots)
+    {
+        for (Slot &slot : m_slots)
+            slot.buf.reserve(size);
+    }
+
+    QByteArray *acquire(int size)
+    {
+        const int n = int(m_slots.size());
+
+        for (int i = 0; i < n; i++) {
+            Slot &slot = m_slots[m_next];
+            m_next = (m_next + 1) % n;
+
+            // busy covers the window between acquire() and publish(),
+            // when the slot is still detached but already handed out.
+            if (slot.busy || !slot.buf.isDetached())
+                continue;
+
+            slot.busy = true;
+            slot.buf.resize(size);  // capacity is retained; no alloc
+            return &slot.buf;
+        }
+
+        return nullptr;
+    }
+
+    void publish(QByteArray *buf)
+    {
+        for (Slot &slot : m_slots) {
+            if (&slot.buf == buf) {
+                slot.busy = false;
+                return;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        QByteArray buf;
+        bool busy = false;
+    };
+
+    std::vector<Slot> m_slots;
+    int m_next = 0;
+};
+
+#endif // BUFFERPOOL_H
@@ -0,0 +1,49 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * checksum.h -- 16 bit additive checksum over track payloads
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <QtGlobal>
+
+namespace fdc {
+
+// Reference byte-at-a-time implementation.  Kept for short runs
+// (command blocks) and for validating the accelerated kernels.
+inline quint16 checksumScalar(const quint8 *p, int len)
+{
+    quint16 sum = 0;
+
+    while (len--)
+        sum += *p++;
+
+    return sum;
+}
+
+// Accelerated checksum.  Dispatches once at startup to SSE2, NEON or a
+// wide-accumulator portable kernel depending on what the CPU offers;
+// always returns the same value as checksumScalar().
+quint16 checksum(const quint8 *p, int len);
+
+// Compile-time-length checksum.  With the byte count a template
+// argument the trip count is a literal, so the compiler unrolls and
+// vectorizes the loop itself with no kernel dispatch or length
+// branches; used by the track geometry fast paths for short fixed
+// runs like a 137 byte sector.
+template <int N>
+inline quint16 checksumFixed(const quint8 *p)
+{
+    quint16 sum = 0;
+
+    for (int i = 0; i < N; i++)
+        sum += p[i];
+
+    return sum;
+}
+
+} // namespace fdc
+
+#endif // CHECKSUM_H
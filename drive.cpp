@@ -0,0 +1,845 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * drive.cpp -- mounted disk image access
+ */
+
+#include "drive.h"
+#include "fdcproto.h"
+#include "imagecontainer.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include <cstring>
+
+using fdc::inferGeometry;
+
+Drive::~Drive()
+{
+    unmount();
+}
+
+bool Drive::mount(const QString &path, Backend backend, QString *error)
+{
+    unmount();
+
+    QMutexLocker locker(&m_lock);
+
+    // Compressed containers bypass the backend choice: the compressed
+    // blobs are resident, tracks expand lazily on first access.
+    if (ImageContainer::isContainer(path)) {
+        if (!ImageContainer::load(path, &m_trackLen, &m_trackCount,
+                                  &m_ctracks, error))
+            return false;
+
+        m_compressed = true;
+        m_backend = backend;
+        m_file.setFileName(path);
+        m_dirtyBits.assign((m_trackCount + 63) / 64, 0);
+        m_writtenBits.assign((m_trackCount + 63) / 64, 0);
+        computeInterleaveLocked();
+        return true;
+    }
+
+    if (backend == Backend::Shared) {
+        auto image = ImagePool::acquire(path, error);
+        if (!image)
+            return false;
+
+        if (!inferGeometry(image->data.size(), &m_trackLen, &m_trackCount)) {
+            if (error)
+                *error = QStringLiteral("%1: not a recognized image size (%2 bytes)")
+                             .arg(path).arg(image->data.size());
+            return false;
+        }
+
+        m_shared = image;
+        m_backend = backend;
+        m_file.setFileName(path);
+        m_dirtyBits.assign((m_trackCount + 63) / 64, 0);
+        m_writtenBits.assign((m_trackCount + 63) / 64, 0);
+        computeInterleaveLocked();
+        return true;
+    }
+
+    if (backend == Backend::Overlay) {
+        m_file.setFileName(path);
+
+        // The master is never opened for writing.
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            if (error)
+                *error = m_file.errorString();
+            return false;
+        }
+
+        if (!inferGeometry(m_file.size(), &m_trackLen, &m_trackCount)) {
+            m_file.close();
+            if (error)
+                *error = QStringLiteral("%1: not a recognized image size (%2 bytes)")
+                             .arg(path).arg(m_file.size());
+            return false;
+        }
+
+        if (!openOverlayLocked(path + QStringLiteral(".ovl"), error)) {
+            m_file.close();
+            return false;
+        }
+
+        m_backend = backend;
+        m_dirtyBits.assign((m_trackCount + 63) / 64, 0);
+        m_writtenBits.assign((m_trackCount + 63) / 64, 0);
+        computeInterleaveLocked();
+        return true;
+    }
+
+    m_file.setFileName(path);
+
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        if (error)
+            *error = m_file.errorString();
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+
+    if (!inferGeometry(size, &m_trackLen, &m_trackCount)) {
+        m_file.close();
+        if (error)
+            *error = QStringLiteral("%1: not a recognized image size (%2 bytes)")
+                         .arg(path).arg(size);
+        return false;
+    }
+
+    m_backend = backend;
+    m_dirtySinceFlush = 0;
+    m_dirtyBits.assign((m_trackCount + 63) / 64, 0);
+    m_writtenBits.assign((m_trackCount + 63) / 64, 0);
+    computeInterleaveLocked();
+
+    if (m_backend == Backend::Pinned) {
+        // Register now, load later: the drive answers STAT (and serves
+        // READs straight from the file) while the loader streams the
+        // image into the arena.
+        m_arena.resize(size);
+        m_loadedTracks.store(0);
+        m_loadStop.store(false);
+        m_loadFuture = QtConcurrent::run([this] { loadArena(); });
+        return true;
+    }
+
+    if (m_backend == Backend::Mapped) {
+        m_map = m_file.map(0, size);
+        if (!m_map) {
+            m_file.close();
+            if (error)
+                *error = QStringLiteral("%1: cannot map image: %2")
+                             .arg(path, m_file.errorString());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Open (or create) the session overlay and build the in-memory track
+// index from its records: a 12 byte header, then appended
+// [track number, track bytes] records, last record for a track wins.
+bool Drive::openOverlayLocked(const QString &path, QString *error)
+{
+    m_overlay.setFileName(path);
+    m_overlayIndex.clear();
+
+    if (!m_overlay.open(QIODevice::ReadWrite)) {
+        if (error)
+            *error = m_overlay.errorString();
+        return false;
+    }
+
+    quint8 header[12];
+
+    if (m_overlay.size() == 0) {
+        memcpy(header, "FDCO", 4);
+        fdc::putWord(header + 4, 1);
+        fdc::putWord(header + 6, quint16(m_trackLen));
+        fdc::putWord(header + 8, quint16(m_trackCount));
+        fdc::putWord(header + 10, 0);
+        if (m_overlay.write(reinterpret_cast<const char *>(header), 12)
+            != 12) {
+            if (error)
+                *error = m_overlay.errorString();
+            m_overlay.close();
+            return false;
+        }
+        return true;
+    }
+
+    if (m_overlay.read(reinterpret_cast<char *>(header), 12) != 12
+        || memcmp(header, "FDCO", 4) != 0
+        || fdc::getWord(header + 6) != m_trackLen
+        || fdc::getWord(header + 8) != m_trackCount) {
+        if (error)
+            *error = QStringLiteral("%1: not an overlay for this image")
+                         .arg(path);
+        m_overlay.close();
+        return false;
+    }
+
+    const qint64 recLen = 4 + m_trackLen;
+    for (qint64 pos = 12; pos + recLen <= m_overlay.size(); pos += recLen) {
+        quint8 rec[4];
+        if (!m_overlay.seek(pos)
+            || m_overlay.read(reinterpret_cast<char *>(rec), 4) != 4)
+            break;
+        const int track = fdc::getWord(rec);
+        if (track >= 0 && track < m_trackCount)
+            m_overlayIndex.insert(track, pos + 4);
+    }
+
+    return true;
+}
+
+// Background arena fill for the pinned backend, one track per lock
+// hold so live traffic never waits long.  Tracks a WRIT already
+// dirtied are skipped -- the arena copy is newer than the file.
+void Drive::loadArena()
+{
+    for (int track = 0;; track++) {
+        if (m_loadStop.load(std::memory_order_relaxed))
+            return;
+
+        QMutexLocker locker(&m_lock);
+
+        if (m_arena.isEmpty() || track >= m_trackCount)
+            return;
+
+        if (!dirtyLocked(track)) {
+            if (!m_file.seek(qint64(track) * m_trackLen)
+                || m_file.read(m_arena.data() + qint64(track) * m_trackLen,
+                               m_trackLen) != m_trackLen)
+                return;
+        }
+
+        m_loadedTracks.store(track + 1, std::memory_order_release);
+    }
+}
+
+void Drive::unmount()
+{
+    // Stop the loader before taking the lock; it acquires it per
+    // track.
+    m_loadStop.store(true);
+    m_loadFuture.waitForFinished();
+
+    QMutexLocker locker(&m_lock);
+
+    if (m_compressed) {
+        saveLocked(nullptr);
+        m_cowTracks.clear();
+        m_ctracks.clear();
+        m_compressed = false;
+    }
+
+    if (m_shared) {
+        // Push this session's still-dirty tracks back to the backing
+        // file.  Drives sharing the buffer write back independently;
+        // keep masters that must stay pristine on their own copies.
+        saveLocked(nullptr);
+        m_cowTracks.clear();
+        m_shared.reset();
+    }
+
+    if (!m_arena.isEmpty()) {
+        // Everything still dirty goes back before the arena is freed.
+        while (flushDirtyLocked(m_trackCount) > 0) {
+        }
+        m_arena.clear();
+        m_dirtyBits.clear();
+    }
+
+    if (m_overlay.isOpen()) {
+        m_overlay.close();
+        m_overlayIndex.clear();
+    }
+
+    if (m_file.isOpen()) {
+        flushLocked();
+        if (m_map)
+            m_file.unmap(m_map);
+        m_file.close();
+    }
+
+    m_map = nullptr;
+    m_trackCount = 0;
+    m_trackLen = 0;
+    m_interleave.clear();
+    m_dirtyBits.clear();
+    m_writtenBits.clear();
+}
+
+bool Drive::isMounted() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_file.isOpen() || m_shared || m_compressed;
+}
+
+QString Drive::fileName() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_file.fileName();
+}
+
+Drive::Backend Drive::backend() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_backend;
+}
+
+void Drive::setWriteBehind(bool on)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_writeBehind = on;
+}
+
+bool Drive::writeBehind() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_writeBehind;
+}
+
+void Drive::setInterleave(int factor)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_interleaveFactor = qMax(1, factor);
+    computeInterleaveLocked();
+}
+
+const std::vector<int> &Drive::interleaveOrder() const
+{
+    return m_interleave;
+}
+
+void Drive::computeInterleaveLocked()
+{
+    // Geometry-derived tables are refreshed together: the interleave
+    // permutation below and the specialized checksum kernel.
+    m_trackSum = fdc::trackChecksumFor(m_trackLen);
+
+    m_interleave.clear();
+
+    if (m_interleaveFactor <= 1 || m_trackLen <= 0
+        || m_trackLen % fdc::SectorLen != 0)
+        return;
+
+    // Standard soft-interleave layout: logical sector s lands in the
+    // next free physical slot, stepping by the factor.  The table maps
+    // emission slot to logical sector.
+    const int sectors = m_trackLen / fdc::SectorLen;
+    m_interleave.assign(sectors, -1);
+
+    int slot = 0;
+    for (int logical = 0; logical < sectors; logical++) {
+        while (m_interleave[slot] >= 0)
+            slot = (slot + 1) % sectors;
+        m_interleave[slot] = logical;
+        slot = (slot + m_interleaveFactor) % sectors;
+    }
+}
+
+int Drive::trackCount() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_trackCount;
+}
+
+int Drive::trackLen() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_trackLen;
+}
+
+bool Drive::readTrack(int track, quint8 *buf)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (track < 0 || track >= m_trackCount)
+        return false;
+
+    if (m_compressed) {
+        const quint8 *src = expandedLocked(track);
+        if (!src)
+            return false;
+        memcpy(buf, src, m_trackLen);
+        return true;
+    }
+
+    if (m_shared) {
+        auto it = m_cowTracks.constFind(track);
+        const char *src = it != m_cowTracks.constEnd()
+            ? it.value().constData()
+            : m_shared->data.constData() + qint64(track) * m_trackLen;
+        memcpy(buf, src, m_trackLen);
+        return true;
+    }
+
+    if (!m_arena.isEmpty()) {
+        // A READ ahead of the loader watermark (and not dirtied by a
+        // WRIT that landed in the arena) is served from the file.
+        if (track < m_loadedTracks.load(std::memory_order_acquire)
+            || dirtyLocked(track)) {
+            memcpy(buf, m_arena.constData() + qint64(track) * m_trackLen,
+                   m_trackLen);
+            return true;
+        }
+
+        return m_file.seek(qint64(track) * m_trackLen)
+               && m_file.read(reinterpret_cast<char *>(buf), m_trackLen)
+                      == m_trackLen;
+    }
+
+    if (!m_file.isOpen())
+        return false;
+
+    if (m_backend == Backend::Overlay) {
+        // One hash probe decides the source; the master is consulted
+        // only for tracks the session has not written.
+        auto it = m_overlayIndex.constFind(track);
+        QFile &src = it != m_overlayIndex.constEnd() ? m_overlay : m_file;
+        const qint64 offset = it != m_overlayIndex.constEnd()
+            ? it.value()
+            : qint64(track) * m_trackLen;
+
+        return src.seek(offset)
+               && src.read(reinterpret_cast<char *>(buf), m_trackLen)
+                      == m_trackLen;
+    }
+
+    if (m_map) {
+        memcpy(buf, m_map + qint64(track) * m_trackLen, m_trackLen);
+        return true;
+    }
+
+    if (!m_file.seek(qint64(track) * m_trackLen))
+        return false;
+
+    return m_file.read(reinterpret_cast<char *>(buf), m_trackLen) == m_trackLen;
+}
+
+bool Drive::writeTrack(int track, const quint8 *data)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (track < 0 || track >= m_trackCount)
+        return false;
+
+    if (!writeTrackLocked(track, data))
+        return false;
+
+    if (!m_writtenBits.empty())
+        m_writtenBits[track / 64] |= quint64(1) << (track % 64);
+
+    return true;
+}
+
+bool Drive::writeTrackLocked(int track, const quint8 *data)
+{
+    if (m_compressed) {
+        // The expanded copy becomes authoritative; the stale blob is
+        // recompressed at save time.
+        m_cowTracks.insert(track,
+                           QByteArray(reinterpret_cast<const char *>(data),
+                                      m_trackLen));
+        markDirtyLocked(track);
+        return true;
+    }
+
+    if (m_shared) {
+        // Copy-on-write: the shared buffer stays pristine, this drive
+        // gets a private copy of the dirtied track.
+        m_cowTracks.insert(track,
+                           QByteArray(reinterpret_cast<const char *>(data),
+                                      m_trackLen));
+        markDirtyLocked(track);
+        return true;
+    }
+
+    if (!m_arena.isEmpty()) {
+        memcpy(m_arena.data() + qint64(track) * m_trackLen, data, m_trackLen);
+        markDirtyLocked(track);
+        return true;
+    }
+
+    if (!m_file.isOpen())
+        return false;
+
+    if (m_backend == Backend::Overlay) {
+        // Rewrite the session's existing record in place, or append a
+        // new one; the master is never touched.
+        auto it = m_overlayIndex.constFind(track);
+        if (it != m_overlayIndex.constEnd()) {
+            if (!m_overlay.seek(it.value())
+                || m_overlay.write(reinterpret_cast<const char *>(data),
+                                   m_trackLen) != m_trackLen)
+                return false;
+        } else {
+            const qint64 end = m_overlay.size();
+            quint8 rec[4];
+            fdc::putWord(rec, quint16(track));
+            fdc::putWord(rec + 2, 0);
+            if (!m_overlay.seek(end)
+                || m_overlay.write(reinterpret_cast<const char *>(rec), 4)
+                       != 4
+                || m_overlay.write(reinterpret_cast<const char *>(data),
+                                   m_trackLen) != m_trackLen)
+                return false;
+            m_overlayIndex.insert(track, end + 4);
+        }
+
+        m_overlay.flush();
+        return true;
+    }
+
+    if (m_map) {
+        memcpy(m_map + qint64(track) * m_trackLen, data, m_trackLen);
+        if (++m_dirtySinceFlush >= FlushEvery)
+            flushLocked();
+        return true;
+    }
+
+    if (!m_file.seek(qint64(track) * m_trackLen))
+        return false;
+
+    if (m_file.write(reinterpret_cast<const char *>(data), m_trackLen) != m_trackLen)
+        return false;
+
+    m_file.flush();
+
+    return true;
+}
+
+bool Drive::trackWritten(int track) const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (track < 0 || track >= m_trackCount || m_writtenBits.empty())
+        return false;
+
+    return m_writtenBits[track / 64] & (quint64(1) << (track % 64));
+}
+
+bool Drive::refetchTrack(int track)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (track < 0 || track >= m_trackCount || dirtyLocked(track))
+        return false;
+
+    if (m_compressed) {
+        // Drop the cached expansion; the next access re-expands from
+        // the compressed blob.
+        m_cowTracks.remove(track);
+        return true;
+    }
+
+    if (m_shared) {
+        // A fresh read from the backing file shadows the (possibly
+        // rotted) shared buffer as a private copy.  Not marked dirty:
+        // it matches what is on disk.
+        bool wasOpen = m_file.isOpen();
+
+        if (!wasOpen && !m_file.open(QIODevice::ReadOnly))
+            return false;
+
+        QByteArray fresh(m_trackLen, Qt::Uninitialized);
+        const bool ok = m_file.seek(qint64(track) * m_trackLen)
+                        && m_file.read(fresh.data(), m_trackLen)
+                               == m_trackLen;
+
+        if (!wasOpen)
+            m_file.close();
+        if (!ok)
+            return false;
+
+        m_cowTracks.insert(track, fresh);
+        return true;
+    }
+
+    if (!m_arena.isEmpty()) {
+        if (!m_file.seek(qint64(track) * m_trackLen)
+            || m_file.read(m_arena.data() + qint64(track) * m_trackLen,
+                           m_trackLen) != m_trackLen)
+            return false;
+
+        return true;
+    }
+
+    // Mapped, overlay and buffered traffic reads the master directly;
+    // there is no second copy to restore from.
+    return false;
+}
+
+const quint8 *Drive::constTrack(int track) const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (track < 0 || track >= m_trackCount)
+        return nullptr;
+
+    if (m_compressed)
+        return expandedLocked(track);
+
+    if (m_shared) {
+        auto it = m_cowTracks.constFind(track);
+        const char *src = it != m_cowTracks.constEnd()
+            ? it.value().constData()
+            : m_shared->data.constData() + qint64(track) * m_trackLen;
+        return reinterpret_cast<const quint8 *>(src);
+    }
+
+    if (!m_arena.isEmpty()) {
+        // Stable only once the loader has passed the track (or a WRIT
+        // made the arena copy authoritative); callers fall back to
+        // readTrack() otherwise.
+        if (track < m_loadedTracks.load(std::memory_order_acquire)
+            || dirtyLocked(track))
+            return reinterpret_cast<const quint8 *>(m_arena.constData())
+                   + qint64(track) * m_trackLen;
+        return nullptr;
+    }
+
+    if (!m_map)
+        return nullptr;
+
+    return m_map + qint64(track) * m_trackLen;
+}
+
+void Drive::flush()
+{
+    QMutexLocker locker(&m_lock);
+
+    flushLocked();
+}
+
+bool Drive::save(QString *error)
+{
+    QMutexLocker locker(&m_lock);
+
+    return saveLocked(error);
+}
+
+int Drive::loadPercent() const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_arena.isEmpty() || m_trackCount <= 0)
+        return 100;
+
+    return qMin(100, m_loadedTracks.load(std::memory_order_relaxed) * 100
+                         / m_trackCount);
+}
+
+quint16 Drive::trackChecksum(const quint8 *data) const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_trackSum)
+        return m_trackSum(data);
+
+    return fdc::checksum(data, m_trackLen);
+}
+
+int Drive::dirtyTrackCount() const
+{
+    QMutexLocker locker(&m_lock);
+
+    int count = 0;
+    for (quint64 word : m_dirtyBits)
+        count += qPopulationCount(word);
+
+    return count;
+}
+
+// Expanded bytes for a track of a compressed image, materializing them
+// on first access; null on a corrupt stream.  The expanded copies live
+// in m_cowTracks, whose heap storage stays put across rehashes, so the
+// returned pointer is stable until unmount.
+const quint8 *Drive::expandedLocked(int track) const
+{
+    auto it = m_cowTracks.constFind(track);
+    if (it != m_cowTracks.constEnd())
+        return reinterpret_cast<const quint8 *>(it.value().constData());
+
+    QByteArray expanded(m_trackLen, Qt::Uninitialized);
+    if (!ImageContainer::expandTrack(m_ctracks[track],
+                                     reinterpret_cast<quint8 *>(
+                                         expanded.data()),
+                                     m_trackLen))
+        return nullptr;
+
+    it = m_cowTracks.insert(track, expanded);
+
+    return reinterpret_cast<const quint8 *>(it.value().constData());
+}
+
+bool Drive::saveLocked(QString *error)
+{
+    if (m_compressed) {
+        bool any = false;
+
+        for (auto it = m_cowTracks.constBegin();
+             it != m_cowTracks.constEnd(); ++it) {
+            const int track = it.key();
+            quint64 &word = m_dirtyBits[track / 64];
+            const quint64 bit = quint64(1) << (track % 64);
+
+            if (!(word & bit))
+                continue;
+
+            m_ctracks[track] = ImageContainer::compressTrack(
+                reinterpret_cast<const quint8 *>(it.value().constData()),
+                m_trackLen);
+            word &= ~bit;
+            any = true;
+        }
+
+        // Stored lengths shift when tracks recompress, so a dirty save
+        // rewrites the container; it is a fraction of the raw size.
+        if (!any)
+            return true;
+
+        return ImageContainer::store(m_file.fileName(), m_trackLen,
+                                     m_ctracks, error);
+    }
+
+    if (m_shared) {
+        bool wasOpen = m_file.isOpen();
+
+        if (!wasOpen && !m_file.open(QIODevice::ReadWrite)) {
+            if (error)
+                *error = m_file.errorString();
+            return false;
+        }
+
+        // Only tracks dirtied since the last save; earlier COW copies
+        // stay around for reads but are already on disk.
+        for (auto it = m_cowTracks.constBegin();
+             it != m_cowTracks.constEnd(); ++it) {
+            const int track = it.key();
+            quint64 &word = m_dirtyBits[track / 64];
+            const quint64 bit = quint64(1) << (track % 64);
+
+            if (!(word & bit))
+                continue;
+
+            if (!m_file.seek(qint64(track) * m_trackLen)
+                || m_file.write(it.value()) != m_trackLen) {
+                if (error)
+                    *error = m_file.errorString();
+                if (!wasOpen)
+                    m_file.close();
+                return false;
+            }
+
+            word &= ~bit;
+        }
+
+        if (!wasOpen)
+            m_file.close();
+        return true;
+    }
+
+    if (!m_arena.isEmpty()) {
+        while (flushDirtyLocked(m_trackCount) > 0) {
+        }
+
+        for (quint64 word : m_dirtyBits) {
+            if (word != 0) {
+                if (error)
+                    *error = m_file.errorString();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Buffered writes go straight through; mapped writes only need the
+    // pending flush pushed out.
+    flushLocked();
+    return true;
+}
+
+int Drive::flushDirtyTracks(int maxTracks)
+{
+    QMutexLocker locker(&m_lock);
+
+    return flushDirtyLocked(maxTracks);
+}
+
+int Drive::flushDirtyLocked(int maxTracks)
+{
+    if (m_arena.isEmpty() || !m_file.isOpen())
+        return 0;
+
+    int written = 0;
+
+    for (int track = 0; track < m_trackCount && written < maxTracks; track++) {
+        quint64 &word = m_dirtyBits[track / 64];
+        const quint64 bit = quint64(1) << (track % 64);
+
+        if (!(word & bit))
+            continue;
+
+        if (!m_file.seek(qint64(track) * m_trackLen))
+            break;
+        if (m_file.write(m_arena.constData() + qint64(track) * m_trackLen,
+                         m_trackLen) != m_trackLen)
+            break;
+
+        word &= ~bit;
+        written++;
+    }
+
+    if (written > 0)
+        m_file.flush();
+
+    return written;
+}
+
+void Drive::flushLocked()
+{
+    // Mapped writes land in the mapping, never in QFile's write
+    // buffer, so QFile::flush() would push nothing; sync the mapped
+    // pages themselves.
+    if (m_map && m_dirtySinceFlush > 0) {
+#if defined(Q_OS_WIN)
+        FlushViewOfFile(m_map, 0);
+#else
+        msync(m_map, size_t(qint64(m_trackCount) * m_trackLen), MS_SYNC);
+#endif
+    }
+
+    m_dirtySinceFlush = 0;
+}
+
+void Drive::markDirtyLocked(int track)
+{
+    m_dirtyBits[track / 64] |= quint64(1) << (track % 64);
+}
+
+bool Drive::dirtyLocked(int track) const
+{
+    return m_dirtyBits[track / 64] & (quint64(1) << (track % 64));
+}
@@ -0,0 +1,203 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * drive.h -- mounted disk image access
+ */
+
+#ifndef DRIVE_H
+#define DRIVE_H
+
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <atomic>
+#include <vector>
+
+#include "imagepool.h"
+#include "trackgeometry.h"
+
+/*
+ * One mounted .dsk image.  Geometry is inferred from the file size at
+ * mount time; images that are a whole number of 8 inch tracks but match
+ * no classic size (e.g. hard disk images) are treated as generic
+ * 4384 byte track images.
+ *
+ * Three backends are available, chosen at mount time.  Buffered goes
+ * through QFile reads and writes as before.  Mapped maps the whole
+ * image with QFile::map() and serves reads straight out of the mapping
+ * with no copy; writes land in the mapping and their pages are synced
+ * to storage (msync) after every FlushEvery dirtied tracks and on
+ * unmount.  Shared pulls a
+ * read-only buffer from the ImagePool -- deduplicated across drives, so
+ * identical images are resident once -- and gives this drive a private
+ * copy of a track only when a WRIT dirties it; dirtied tracks are
+ * written back to the file on unmount.  Pinned loads the whole image
+ * into a private contiguous arena, serves all traffic from memory, and
+ * tracks dirtied tracks in a bitmap that a low-priority thread (or
+ * unmount) writes back lazily -- storage is off the latency path
+ * entirely.  The arena fills asynchronously: mount() registers the
+ * drive and returns at once (so STAT succeeds immediately even for a
+ * large hard disk image), a background loader streams tracks in, and a
+ * READ ahead of the loader is served straight from the file instead of
+ * stalling.
+ *
+ * Overlay opens the master image strictly read-only and pairs it with
+ * a sparse per-session overlay file (<image>.ovl) holding only the
+ * tracks WRIT has touched.  An in-memory index decides per READ
+ * whether the overlay or the master serves -- a hash probe, never a
+ * file probe -- so sessions start instantly with zero copying and the
+ * master stays pristine no matter what a visitor writes.
+ *
+ * Compressed .cdsk containers (see imagecontainer.h) mount directly
+ * regardless of the backend choice: the compressed blobs are resident,
+ * each track is expanded lazily on first access, and a save
+ * recompresses the dirtied tracks.
+ *
+ * All in-memory backends maintain a dirty-track bitmap fed by WRIT, so
+ * save() and unmount rewrite only the tracks a session touched; saving
+ * a lightly-used image is proportional to the modification volume, not
+ * the image size.
+ *
+ * Track reads may run on the read-ahead worker while the serial slot is
+ * writing, so file access is serialized internally.
+ */
+class Drive
+{
+public:
+    enum class Backend {
+        Buffered,
+        Mapped,
+        Shared,
+        Pinned,
+        Overlay
+    };
+
+    // Mapped backend: dirtied tracks accumulated before a flush.
+    static constexpr int FlushEvery = 8;
+
+    Drive() = default;
+    ~Drive();
+
+    bool mount(const QString &path, Backend backend = Backend::Buffered,
+               QString *error = nullptr);
+    void unmount();
+    bool isMounted() const;
+
+    QString fileName() const;
+    Backend backend() const;
+
+    // Write-behind: WRIT is acknowledged once captured by the journal
+    // instead of after the track reaches storage.
+    void setWriteBehind(bool on);
+    bool writeBehind() const;
+    int trackCount() const;
+    int trackLen() const;
+
+    bool readTrack(int track, quint8 *buf);
+    bool writeTrack(int track, const quint8 *data);
+
+    // Whether the track has been written at any point this session
+    // (never cleared by a save); the scrubber uses this to tell a
+    // legitimate change from corruption.
+    bool trackWritten(int track) const;
+
+    // Scrubber repair path: discard the in-memory copy of an unwritten
+    // track and restore it from the master bytes -- the backing file
+    // for pinned and shared images, the compressed blob for .cdsk
+    // mounts.  False for backends that read the master directly (there
+    // is no second copy to restore from) and for dirtied tracks.
+    bool refetchTrack(int track);
+
+    // Sector interleave for track transmission.  A factor of 1 sends
+    // sectors sequentially; higher factors emit them in the physical
+    // interleave order the controller's timing expects.  The emission
+    // permutation is precomputed here so transmission pays nothing per
+    // request; the returned order is stable while the drive stays
+    // mounted (empty when sequential).
+    void setInterleave(int factor);
+    const std::vector<int> &interleaveOrder() const;
+
+    // Mapped and Shared backends: a stable pointer to the track bytes,
+    // usable for zero-copy transmission, valid until unmount (or, for a
+    // shared track, until a WRIT replaces it with a private copy).
+    // Null for the buffered backend.
+    const quint8 *constTrack(int track) const;
+
+    // Push any unflushed mapped writes out to the file.
+    void flush();
+
+    // Incremental save: seek and rewrite only the tracks WRIT has
+    // dirtied since mount (or since the last save), so saving a
+    // lightly-modified image costs a few track writes rather than a
+    // whole-file rewrite.  The image stays mounted.
+    bool save(QString *error = nullptr);
+
+    // Tracks currently dirtied and not yet saved.
+    int dirtyTrackCount() const;
+
+    // Additive checksum of one full track of data.  Runs the
+    // compile-time specialized kernel for the geometry selected at
+    // mount (constant-folded loop bounds, no length dispatch); odd
+    // geometries take the generic runtime-length path.
+    quint16 trackChecksum(const quint8 *data) const;
+
+    // Pinned backend: how much of the arena the background loader has
+    // filled, 0-100.  100 for every other backend.
+    int loadPercent() const;
+
+    // Pinned backend: write back up to maxTracks dirtied tracks and
+    // clear their bits.  Returns how many were written; the lazy
+    // flusher calls this until it reports zero.
+    int flushDirtyTracks(int maxTracks);
+
+private:
+    void computeInterleaveLocked();
+    bool writeTrackLocked(int track, const quint8 *data);
+    bool openOverlayLocked(const QString &path, QString *error);
+    const quint8 *expandedLocked(int track) const;
+    bool saveLocked(QString *error);
+    int flushDirtyLocked(int maxTracks);
+    void flushLocked();
+    void markDirtyLocked(int track);
+    bool dirtyLocked(int track) const;
+    void loadArena();
+
+    mutable QMutex m_lock;
+    QFile m_file;
+    Backend m_backend = Backend::Buffered;
+    bool m_writeBehind = false;
+    uchar *m_map = nullptr;
+    QSharedPointer<SharedImage> m_shared;
+    // Shared backend: private copies of dirtied tracks.  Compressed
+    // images: lazily expanded tracks (mutable so a const read can
+    // materialize one).
+    mutable QHash<int, QByteArray> m_cowTracks;
+    bool m_compressed = false;
+    std::vector<QByteArray> m_ctracks;
+    // Overlay backend: session file and track -> payload offset index.
+    QFile m_overlay;
+    QHash<int, qint64> m_overlayIndex;
+    QByteArray m_arena;
+    // Pinned backend: loader watermark (tracks 0..N-1 are in the
+    // arena) and its stop flag/future.
+    std::atomic<int> m_loadedTracks { 0 };
+    std::atomic<bool> m_loadStop { false };
+    QFuture<void> m_loadFuture;
+    std::vector<quint64> m_dirtyBits;
+    // Tracks written this session; unlike the dirty bitmap this is
+    // never cleared by a save.
+    std::vector<quint64> m_writtenBits;
+    int m_interleaveFactor = 1;
+    std::vector<int> m_interleave;
+    // Geometry-specialized whole-track checksum; null for geometries
+    // outside the known set.
+    fdc::TrackChecksumFn m_trackSum = nullptr;
+    int m_dirtySinceFlush = 0;
+    int m_trackCount = 0;
+    int m_trackLen = 0;
+};
+
+#endif // DRIVE_H
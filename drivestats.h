@@ -0,0 +1,84 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * drivestats.h -- per-drive operation ledger
+ */
+
+#ifndef DRIVESTATS_H
+#define DRIVESTATS_H
+
+#include <QString>
+
+#include <atomic>
+
+/*
+ * Running counters for one drive, bumped on the engine threads with
+ * relaxed atomics -- the hot path pays one uncontended add per event
+ * and never a lock.  The GUI samples the whole ledger once a second;
+ * exact cross-counter consistency does not matter at that cadence.
+ *
+ * Retries are counted as negative acknowledges: the FDC+ reissues a
+ * command it got a NOT for, so every nack the server sends comes back
+ * as another attempt.
+ */
+struct DriveStats
+{
+    std::atomic<quint64> reads { 0 };
+    std::atomic<quint64> writes { 0 };
+    std::atomic<quint64> retries { 0 };
+    std::atomic<quint64> crcFailures { 0 };
+    std::atomic<quint64> bytesRead { 0 };
+    std::atomic<quint64> bytesWritten { 0 };
+
+    void countRead(quint64 bytes)
+    {
+        reads.fetch_add(1, std::memory_order_relaxed);
+        bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void countWrite(quint64 bytes)
+    {
+        writes.fetch_add(1, std::memory_order_relaxed);
+        bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void countRetry() { retries.fetch_add(1, std::memory_order_relaxed); }
+
+    void countCrcFailure()
+    {
+        crcFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        reads.store(0);
+        writes.store(0);
+        retries.store(0);
+        crcFailures.store(0);
+        bytesRead.store(0);
+        bytesWritten.store(0);
+    }
+
+    static QString csvHeader()
+    {
+        return QStringLiteral("drive,reads,writes,retries,crc_failures,"
+                              "bytes_read,bytes_written,cache_hits,"
+                              "cache_misses\n");
+    }
+
+    QString csvRow(int unit, quint64 cacheHits, quint64 cacheMisses) const
+    {
+        return QStringLiteral("%1,%2,%3,%4,%5,%6,%7,%8,%9\n")
+            .arg(unit)
+            .arg(reads.load(std::memory_order_relaxed))
+            .arg(writes.load(std::memory_order_relaxed))
+            .arg(retries.load(std::memory_order_relaxed))
+            .arg(crcFailures.load(std::memory_order_relaxed))
+            .arg(bytesRead.load(std::memory_order_relaxed))
+            .arg(bytesWritten.load(std::memory_order_relaxed))
+            .arg(cacheHits)
+            .arg(cacheMisses);
+    }
+};
+
+#endif // DRIVESTATS_H
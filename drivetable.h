@@ -0,0 +1,68 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * drivetable.h -- atomic drive slot table for hot swapping
+ */
+
+#ifndef DRIVETABLE_H
+#define DRIVETABLE_H
+
+#include <atomic>
+
+#include "drive.h"
+#include "fdcproto.h"
+
+/*
+ * The table of drives the protocol engines serve from.  Each slot is a
+ * single atomic pointer: an engine loads it once at the start of a
+ * command and works against that Drive for the command's duration, so
+ * exchanging the pointer swaps which image a unit serves between two
+ * commands -- microseconds of drive downtime instead of the seconds an
+ * unmount/remount cycle costs.  A staged standby image (loaded,
+ * verified, warmed in the background) is swapped in exactly this way.
+ *
+ * The table owns the Drive objects in its slots.  A drive swapped out
+ * is handed back to the caller, which keeps it alive -- an engine may
+ * still be finishing a command against it -- and reuses it as the next
+ * staging slot.
+ */
+class DriveTable
+{
+public:
+    DriveTable()
+    {
+        for (auto &slot : m_slots)
+            slot.store(new Drive, std::memory_order_relaxed);
+    }
+
+    ~DriveTable()
+    {
+        for (auto &slot : m_slots)
+            delete slot.load(std::memory_order_relaxed);
+    }
+
+    DriveTable(const DriveTable &) = delete;
+    DriveTable &operator=(const DriveTable &) = delete;
+
+    // The drive currently serving this unit.  The reference stays valid
+    // across a swap (retired drives are kept), but holders should load
+    // once per command, not cache it.
+    Drive &drive(int unit) const
+    {
+        return *m_slots[unit].load(std::memory_order_acquire);
+    }
+
+    Drive &operator[](int unit) const { return drive(unit); }
+
+    // The hot-swap: the next command on this unit is served from next.
+    // Returns the retired drive; ownership passes to the caller.
+    Drive *exchange(int unit, Drive *next)
+    {
+        return m_slots[unit].exchange(next, std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<Drive *> m_slots[fdc::DriveCount];
+};
+
+#endif // DRIVETABLE_H
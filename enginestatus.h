@@ -0,0 +1,58 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * enginestatus.h -- shared engine status, sampled by the GUI
+ */
+
+#ifndef ENGINESTATUS_H
+#define ENGINESTATUS_H
+
+#include <QElapsedTimer>
+
+#include <atomic>
+
+#include "fdcproto.h"
+
+/*
+ * Live status the engine threads update in place with relaxed stores
+ * -- no signal, no event, no allocation per serviced command.  The
+ * GUI samples it on a 30 Hz timer and repaints only what changed, so
+ * a full-rate transfer costs the event loop thirty label updates a
+ * second instead of a queued event per command.
+ */
+struct EngineStatus
+{
+    struct DriveStatus {
+        std::atomic<int> track { -1 };      // last track addressed
+        std::atomic<quint64> ops { 0 };     // commands serviced
+    };
+
+    DriveStatus drives[fdc::DriveCount];
+
+    EngineStatus() { m_clock.start(); }
+
+    void noteServed(int unit, int track)
+    {
+        drives[unit].track.store(track, std::memory_order_relaxed);
+        drives[unit].ops.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Command-arrival clock across all links; idle-time maintenance
+    // keys off how long it has been quiet.
+    void noteCommand()
+    {
+        m_lastCommandMs.store(m_clock.elapsed(), std::memory_order_relaxed);
+    }
+
+    qint64 idleMs() const
+    {
+        return m_clock.elapsed()
+               - m_lastCommandMs.load(std::memory_order_relaxed);
+    }
+
+private:
+    QElapsedTimer m_clock;
+    std::atomic<qint64> m_lastCommandMs { 0 };
+};
+
+#endif // ENGINESTATUS_H
@@ -0,0 +1,120 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * fdc-image-pack.cpp -- convert between raw .dsk and compressed .cdsk
+ *
+ *   fdc-image-pack <input> <output>
+ *
+ * A raw image is packed into a container; a container is unpacked back
+ * to a raw image.  Build target: fdc-image-pack.
+ */
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include <cstdio>
+#include <vector>
+
+#include "fdcproto.h"
+#include "imagecontainer.h"
+
+static int pack(const QString &in, const QString &out)
+{
+    QFile file(in);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "%s: %s\n", qPrintable(in),
+                qPrintable(file.errorString()));
+        return 1;
+    }
+
+    int trackLen, trackCount;
+    if (!fdc::inferGeometry(file.size(), &trackLen, &trackCount)) {
+        fprintf(stderr, "%s: not a recognized image size (%lld bytes)\n",
+                qPrintable(in), (long long)file.size());
+        return 1;
+    }
+
+    std::vector<QByteArray> tracks;
+    tracks.reserve(trackCount);
+
+    QByteArray raw(trackLen, Qt::Uninitialized);
+    for (int i = 0; i < trackCount; i++) {
+        if (file.read(raw.data(), trackLen) != trackLen) {
+            fprintf(stderr, "%s: short read at track %d\n", qPrintable(in), i);
+            return 1;
+        }
+        tracks.push_back(ImageContainer::compressTrack(
+            reinterpret_cast<const quint8 *>(raw.constData()), trackLen));
+    }
+
+    QString error;
+    if (!ImageContainer::store(out, trackLen, tracks, &error)) {
+        fprintf(stderr, "%s: %s\n", qPrintable(out), qPrintable(error));
+        return 1;
+    }
+
+    qint64 stored = 0;
+    for (const QByteArray &t : tracks)
+        stored += t.size();
+
+    printf("%s: %d tracks, %lld -> %lld bytes (%.1fx)\n", qPrintable(out),
+           trackCount, (long long)file.size(), (long long)stored,
+           stored > 0 ? double(file.size()) / double(stored) : 0.0);
+
+    return 0;
+}
+
+static int unpack(const QString &in, const QString &out)
+{
+    int trackLen, trackCount;
+    std::vector<QByteArray> tracks;
+    QString error;
+
+    if (!ImageContainer::load(in, &trackLen, &trackCount, &tracks, &error)) {
+        fprintf(stderr, "%s: %s\n", qPrintable(in), qPrintable(error));
+        return 1;
+    }
+
+    QFile file(out);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        fprintf(stderr, "%s: %s\n", qPrintable(out),
+                qPrintable(file.errorString()));
+        return 1;
+    }
+
+    QByteArray raw(trackLen, Qt::Uninitialized);
+    for (int i = 0; i < trackCount; i++) {
+        if (!ImageContainer::expandTrack(tracks[i],
+                                         reinterpret_cast<quint8 *>(raw.data()),
+                                         trackLen)) {
+            fprintf(stderr, "%s: corrupt track %d\n", qPrintable(in), i);
+            return 1;
+        }
+        if (file.write(raw) != trackLen) {
+            fprintf(stderr, "%s: %s\n", qPrintable(out),
+                    qPrintable(file.errorString()));
+            return 1;
+        }
+    }
+
+    printf("%s: %d tracks, %lld bytes\n", qPrintable(out), trackCount,
+           (long long)file.size());
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: fdc-image-pack <input> <output>\n");
+        return 1;
+    }
+
+    const QString in = QString::fromLocal8Bit(argv[1]);
+    const QString out = QString::fromLocal8Bit(argv[2]);
+
+    return ImageContainer::isContainer(in) ? unpack(in, out) : pack(in, out);
+}
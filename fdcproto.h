@@ -0,0 +1,90 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * fdcproto.h -- FDC+ serial drive protocol definitions
+ *
+ * The FDC+ is the bus master.  Every transaction starts with a ten byte
+ * command block:
+ *
+ *   bytes 0-3   ASCII command ("STAT", "READ" or "WRIT")
+ *   bytes 4-5   param1, LSB first
+ *   bytes 6-7   param2, LSB first
+ *   bytes 8-9   16 bit additive checksum of bytes 0-7, LSB first
+ *
+ * For READ and WRIT, param1 carries the drive number in the upper four
+ * bits and the track number in the lower twelve; param2 is the track
+ * length in bytes.  For STAT, param1 reports the FDC+ drive select and
+ * head load state and param2 is unused.
+ *
+ * The server answers with a block of the same shape whose command field
+ * is "OK  " or "NOT ".  A successful READ response is followed by the
+ * track data and a 16 bit checksum of the data.  A WRIT is acknowledged
+ * first; the FDC+ then sends the track data and checksum, and the
+ * server acknowledges a second time once the track is on disk.
+ */
+
+#ifndef FDCPROTO_H
+#define FDCPROTO_H
+
+#include <QtGlobal>
+
+namespace fdc {
+
+// Command/response block length on the wire.
+constexpr int CmdLen = 10;
+
+// Drives addressable by the FDC+.
+constexpr int DriveCount = 4;
+
+// Largest track length the protocol allows (param2 is bounded by the
+// receive buffer the FDC+ itself carries).
+constexpr int MaxTrackLen = 8192;
+
+// Both Altair formats use 137 byte sectors.
+constexpr int SectorLen = 137;
+
+// Altair 8 inch single density: 137 byte sectors, 32 per track.
+constexpr int TrackLen8 = SectorLen * 32;
+constexpr int Tracks8 = 77;
+
+// Altair minidisk: 137 byte sectors, 16 per track.
+constexpr int TrackLenMini = SectorLen * 16;
+constexpr int TracksMini = 35;
+
+inline quint16 getWord(const quint8 *p)
+{
+    return quint16(p[0] | (p[1] << 8));
+}
+
+inline void putWord(quint8 *p, quint16 v)
+{
+    p[0] = quint8(v & 0xff);
+    p[1] = quint8(v >> 8);
+}
+
+inline int driveOf(quint16 param1) { return (param1 >> 12) & 0x0f; }
+inline int trackOf(quint16 param1) { return param1 & 0x0fff; }
+
+// Geometry from a raw image size: the classic Altair formats first,
+// then anything that is a whole number of 8 inch tracks.
+inline bool inferGeometry(qint64 size, int *trackLen, int *trackCount)
+{
+    if (size == qint64(Tracks8) * TrackLen8) {
+        *trackLen = TrackLen8;
+        *trackCount = Tracks8;
+    } else if (size == qint64(TracksMini) * TrackLenMini) {
+        *trackLen = TrackLenMini;
+        *trackCount = TracksMini;
+    } else if (size > 0 && size % TrackLen8 == 0) {
+        *trackLen = TrackLen8;
+        *trackCount = int(size / TrackLen8);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace fdc
+
+#endif // FDCPROTO_H
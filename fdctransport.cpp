@@ -0,0 +1,128 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * fdctransport.cpp -- byte transports the protocol engine runs over
+ */
+
+#include "fdctransport.h"
+
+#include <QSerialPort>
+#include <QTcpSocket>
+
+FdcTransport *FdcTransport::create(const QString &endpoint, int baud,
+                                   QObject *parent)
+{
+    if (endpoint.startsWith(QLatin1String("tcp:"))) {
+        const QStringList parts = endpoint.mid(4).split(QLatin1Char(':'));
+        const QString host = parts.value(0);
+        const quint16 port = quint16(parts.value(1).toUInt());
+
+        return new TcpTransport(host, port, parent);
+    }
+
+    return new SerialTransport(endpoint, baud, parent);
+}
+
+SerialTransport::SerialTransport(const QString &name, int baud,
+                                 QObject *parent)
+    : FdcTransport(parent)
+{
+    m_port = new QSerialPort(this);
+    m_port->setPortName(name);
+    m_port->setBaudRate(baud);
+    m_port->setDataBits(QSerialPort::Data8);
+    m_port->setParity(QSerialPort::NoParity);
+    m_port->setStopBits(QSerialPort::OneStop);
+    m_port->setFlowControl(QSerialPort::NoFlowControl);
+
+    connect(m_port, &QSerialPort::readyRead,
+            this, &FdcTransport::readyRead);
+}
+
+bool SerialTransport::open(QString *error)
+{
+    if (m_port->isOpen())
+        m_port->close();
+
+    if (!m_port->open(QIODevice::ReadWrite)) {
+        if (error)
+            *error = m_port->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void SerialTransport::close()
+{
+    if (m_port->isOpen())
+        m_port->close();
+}
+
+qint64 SerialTransport::read(char *data, qint64 maxlen)
+{
+    return m_port->read(data, maxlen);
+}
+
+qint64 SerialTransport::write(const char *data, qint64 len)
+{
+    return m_port->write(data, len);
+}
+
+TcpTransport::TcpTransport(const QString &host, quint16 port,
+                           QObject *parent)
+    : FdcTransport(parent)
+    , m_host(host)
+    , m_port(port)
+{
+    m_socket = new QTcpSocket(this);
+
+    connect(m_socket, &QTcpSocket::readyRead,
+            this, &FdcTransport::readyRead);
+}
+
+bool TcpTransport::open(QString *error)
+{
+    if (m_socket->state() != QAbstractSocket::UnconnectedState)
+        m_socket->abort();
+
+    m_socket->connectToHost(m_host, m_port);
+
+    if (!m_socket->waitForConnected(5000)) {
+        if (error)
+            *error = m_socket->errorString();
+        return false;
+    }
+
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_txBatch.clear();
+
+    return true;
+}
+
+void TcpTransport::close()
+{
+    m_socket->abort();
+    m_txBatch.clear();
+}
+
+qint64 TcpTransport::read(char *data, qint64 maxlen)
+{
+    return m_socket->read(data, maxlen);
+}
+
+qint64 TcpTransport::write(const char *data, qint64 len)
+{
+    m_txBatch.append(data, len);
+
+    return len;
+}
+
+void TcpTransport::endResponse()
+{
+    if (m_txBatch.isEmpty())
+        return;
+
+    m_socket->write(m_txBatch);
+    m_txBatch.clear();
+}
@@ -0,0 +1,95 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * fdctransport.h -- byte transports the protocol engine runs over
+ */
+
+#ifndef FDCTRANSPORT_H
+#define FDCTRANSPORT_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+class QSerialPort;
+class QTcpSocket;
+
+/*
+ * The protocol engine talks to an FdcTransport instead of a concrete
+ * QSerialPort, so serial-over-TCP bridges connect directly without an
+ * interposed relay process.  Transports live on the worker thread that
+ * created them.
+ *
+ * An endpoint string selects the implementation: "tcp:host:port" makes
+ * a TCP connection, anything else is treated as a serial port name.
+ */
+class FdcTransport : public QObject
+{
+    Q_OBJECT
+
+public:
+    using QObject::QObject;
+
+    static FdcTransport *create(const QString &endpoint, int baud,
+                                QObject *parent = nullptr);
+
+    virtual bool open(QString *error) = 0;
+    virtual void close() = 0;
+    virtual qint64 read(char *data, qint64 maxlen) = 0;
+    virtual qint64 write(const char *data, qint64 len) = 0;
+
+    // Responses are written in several segments; transports that care
+    // about packetization (TCP) batch them and push once per response.
+    virtual void endResponse() {}
+
+signals:
+    void readyRead();
+};
+
+/*
+ * Local serial port.  Writes go straight to the port; the UART has no
+ * packet boundaries to optimize for.
+ */
+class SerialTransport : public FdcTransport
+{
+    Q_OBJECT
+
+public:
+    SerialTransport(const QString &name, int baud, QObject *parent = nullptr);
+
+    bool open(QString *error) override;
+    void close() override;
+    qint64 read(char *data, qint64 maxlen) override;
+    qint64 write(const char *data, qint64 len) override;
+
+private:
+    QSerialPort *m_port;
+};
+
+/*
+ * Serial-over-TCP bridge.  Opens with TCP_NODELAY so the final flush of
+ * a response is not delayed by Nagle, and batches the segments of a
+ * response into one socket write so each response leaves as a single
+ * burst.
+ */
+class TcpTransport : public FdcTransport
+{
+    Q_OBJECT
+
+public:
+    TcpTransport(const QString &host, quint16 port, QObject *parent = nullptr);
+
+    bool open(QString *error) override;
+    void close() override;
+    qint64 read(char *data, qint64 maxlen) override;
+    qint64 write(const char *data, qint64 len) override;
+    void endResponse() override;
+
+private:
+    QTcpSocket *m_socket;
+    QString m_host;
+    quint16 m_port;
+    QByteArray m_txBatch;
+};
+
+#endif // FDCTRANSPORT_H
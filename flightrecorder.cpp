@@ -0,0 +1,106 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * flightrecorder.cpp -- always-on binary protocol trace ring
+ */
+
+#include "flightrecorder.h"
+
+#include <QFile>
+
+#include <cstring>
+
+// Trace file: 16 byte header, then raw Record structs in capture
+// order.  Host byte order -- the trace is a debugging artifact read
+// back on the machine that wrote it.
+static const char traceMagic[4] = { 'F', 'D', 'C', 'R' };
+static constexpr quint32 traceVersion = 1;
+
+FlightRecorder::FlightRecorder()
+    : m_ring(Capacity)
+{
+    m_clock.start();
+}
+
+bool FlightRecorder::dump(const QString &path, QString *error) const
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    const quint64 next = m_next.load(std::memory_order_acquire);
+    const quint64 first = next > Capacity ? next - Capacity : 0;
+    const quint64 count = next - first;
+
+    quint8 header[16] = {};
+    memcpy(header, traceMagic, 4);
+    memcpy(header + 4, &traceVersion, 4);
+    memcpy(header + 8, &count, 8);
+
+    if (file.write(reinterpret_cast<const char *>(header), 16) != 16) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    for (quint64 i = first; i < next; i++) {
+        const Record &r = m_ring[i & (Capacity - 1)];
+        if (file.write(reinterpret_cast<const char *>(&r), sizeof(r))
+            != sizeof(r)) {
+            if (error)
+                *error = file.errorString();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FlightRecorder::load(const QString &path, std::vector<Record> *records,
+                          QString *error)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    quint8 header[16];
+    quint32 version = 0;
+    quint64 count = 0;
+
+    if (file.read(reinterpret_cast<char *>(header), 16) != 16
+        || memcmp(header, traceMagic, 4) != 0) {
+        if (error)
+            *error = QStringLiteral("%1: not a trace file").arg(path);
+        return false;
+    }
+
+    memcpy(&version, header + 4, 4);
+    memcpy(&count, header + 8, 8);
+
+    if (version != traceVersion) {
+        if (error)
+            *error = QStringLiteral("%1: unsupported trace version %2")
+                         .arg(path).arg(version);
+        return false;
+    }
+
+    records->resize(count);
+    const qint64 bytes = qint64(count) * qint64(sizeof(Record));
+
+    if (file.read(reinterpret_cast<char *>(records->data()), bytes)
+        != bytes) {
+        if (error)
+            *error = QStringLiteral("%1: truncated trace").arg(path);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * flightrecorder.h -- always-on binary protocol trace ring
+ */
+
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <atomic>
+#include <vector>
+
+/*
+ * Flight recorder for the protocol engines: every command and response
+ * is noted as a fixed 16 byte record -- microsecond timestamp, event
+ * code and the two protocol parameters -- in a preallocated ring that
+ * always holds the most recent window of traffic.  The hot path is one
+ * clock read, one relaxed fetch_add and four stores; no formatting, no
+ * allocation, no I/O.  dump() snapshots the ring to a binary file on
+ * demand, and fdc-sds-bench --replay feeds a dump back through a live
+ * server at original or accelerated timing.
+ *
+ * Engines on several links share one recorder; slots are claimed with
+ * an atomic counter, so records interleave in claim order.  A dump
+ * taken while traffic is flowing can catch the very newest slots
+ * mid-write -- the recorder trades that sliver of dump-time precision
+ * for a hot path that never waits.
+ */
+class FlightRecorder
+{
+public:
+    enum Event : quint8 {
+        CmdStat = 1,
+        CmdRead,
+        CmdWrit,
+        CmdWritData,
+        RespOk,
+        RespNot
+    };
+
+    struct Record {
+        quint64 tUs;            // microseconds since the recorder started
+        quint16 param1;
+        quint16 param2;
+        quint8 event;           // Event
+        quint8 reserved[3];
+    };
+
+    // 65536 records, one megabyte resident; minutes of traffic at full
+    // serial rate.
+    static constexpr int CapacityPow2 = 16;
+    static constexpr quint64 Capacity = quint64(1) << CapacityPow2;
+
+    FlightRecorder();
+
+    // Hot path; safe from any thread.
+    void note(Event event, quint16 param1, quint16 param2)
+    {
+        Record &r = m_ring[m_next.fetch_add(1, std::memory_order_relaxed)
+                           & (Capacity - 1)];
+        r.tUs = quint64(m_clock.nsecsElapsed() / 1000);
+        r.param1 = param1;
+        r.param2 = param2;
+        r.event = event;
+    }
+
+    // Snapshot the recorded window, oldest record first, to a binary
+    // trace file.
+    bool dump(const QString &path, QString *error = nullptr) const;
+
+    // Read a trace file back; used by the replay tool.
+    static bool load(const QString &path, std::vector<Record> *records,
+                     QString *error = nullptr);
+
+private:
+    QElapsedTimer m_clock;
+    std::atomic<quint64> m_next { 0 };
+    std::vector<Record> m_ring;
+};
+
+#endif // FLIGHTRECORDER_H
@@ -0,0 +1,32 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * flushthread.cpp -- lazy write-back for pinned drives
+ */
+
+#include "flushthread.h"
+#include "drive.h"
+#include "drivetable.h"
+
+FlushThread::FlushThread(DriveTable *drives, int count, QObject *parent)
+    : QThread(parent)
+    , m_drives(drives)
+    , m_count(count)
+{
+}
+
+FlushThread::~FlushThread()
+{
+    m_stop.store(true);
+    wait();
+}
+
+void FlushThread::run()
+{
+    while (!m_stop.load()) {
+        for (int i = 0; i < m_count; i++)
+            m_drives->drive(i).flushDirtyTracks(TracksPerPass);
+
+        msleep(PassIntervalMs);
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * flushthread.h -- lazy write-back for pinned drives
+ */
+
+#ifndef FLUSHTHREAD_H
+#define FLUSHTHREAD_H
+
+#include <QThread>
+
+#include <atomic>
+
+class DriveTable;
+
+/*
+ * Low-priority background thread that trickles dirtied tracks of
+ * pinned (RAM-resident) drives back to their image files.  It writes a
+ * few tracks per pass and sleeps in between, so it never competes with
+ * the serving threads for long; unmount still forces a full flush.
+ */
+class FlushThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    // Tracks written back per drive per pass.
+    static constexpr int TracksPerPass = 2;
+    static constexpr int PassIntervalMs = 250;
+
+    FlushThread(DriveTable *drives, int count, QObject *parent = nullptr);
+    ~FlushThread();
+
+protected:
+    void run() override;
+
+private:
+    DriveTable *m_drives;
+    int m_count;
+    std::atomic<bool> m_stop { false };
+};
+
+#endif // FLUSHTHREAD_H
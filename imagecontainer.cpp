@@ -0,0 +1,228 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * imagecontainer.cpp -- compressed per-track image container
+ */
+
+#include "imagecontainer.h"
+#include "fdcproto.h"
+
+#include <QFile>
+
+#include <cstring>
+
+static const char containerMagic[4] = { 'F', 'D', 'C', 'Z' };
+static constexpr quint16 containerVersion = 1;
+
+static quint32 getLong(const quint8 *p)
+{
+    return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16)
+           | (quint32(p[3]) << 24);
+}
+
+static void putLong(quint8 *p, quint32 v)
+{
+    p[0] = quint8(v);
+    p[1] = quint8(v >> 8);
+    p[2] = quint8(v >> 16);
+    p[3] = quint8(v >> 24);
+}
+
+bool ImageContainer::isContainer(const QString &path)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    char magic[4];
+    return file.read(magic, 4) == 4
+           && memcmp(magic, containerMagic, 4) == 0;
+}
+
+bool ImageContainer::load(const QString &path, int *trackLen, int *trackCount,
+                          std::vector<QByteArray> *tracks, QString *error)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    quint8 header[12];
+    if (file.read(reinterpret_cast<char *>(header), 12) != 12
+        || memcmp(header, containerMagic, 4) != 0
+        || fdc::getWord(header + 4) != containerVersion) {
+        if (error)
+            *error = QStringLiteral("%1: not a version %2 container")
+                         .arg(path).arg(containerVersion);
+        return false;
+    }
+
+    const int len = fdc::getWord(header + 6);
+    const int count = int(getLong(header + 8));
+
+    if (len <= 0 || len > fdc::MaxTrackLen || count <= 0 || count > 0x1000) {
+        if (error)
+            *error = QStringLiteral("%1: implausible geometry").arg(path);
+        return false;
+    }
+
+    QByteArray table = file.read(qint64(count) * 4);
+    if (table.size() != qint64(count) * 4) {
+        if (error)
+            *error = QStringLiteral("%1: truncated track table").arg(path);
+        return false;
+    }
+
+    tracks->clear();
+    tracks->reserve(count);
+
+    for (int i = 0; i < count; i++) {
+        const quint32 stored =
+            getLong(reinterpret_cast<const quint8 *>(table.constData()) + i * 4);
+
+        if (stored > quint32(len)) {
+            if (error)
+                *error = QStringLiteral("%1: track %2 oversized").arg(path).arg(i);
+            return false;
+        }
+
+        QByteArray blob = file.read(stored);
+        if (blob.size() != qsizetype(stored)) {
+            if (error)
+                *error = QStringLiteral("%1: truncated at track %2")
+                             .arg(path).arg(i);
+            return false;
+        }
+
+        tracks->push_back(blob);
+    }
+
+    *trackLen = len;
+    *trackCount = count;
+
+    return true;
+}
+
+bool ImageContainer::store(const QString &path, int trackLen,
+                           const std::vector<QByteArray> &tracks,
+                           QString *error)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    quint8 header[12];
+    memcpy(header, containerMagic, 4);
+    fdc::putWord(header + 4, containerVersion);
+    fdc::putWord(header + 6, quint16(trackLen));
+    putLong(header + 8, quint32(tracks.size()));
+
+    QByteArray table(qsizetype(tracks.size()) * 4, Qt::Uninitialized);
+    for (size_t i = 0; i < tracks.size(); i++)
+        putLong(reinterpret_cast<quint8 *>(table.data()) + i * 4,
+                quint32(tracks[i].size()));
+
+    bool ok = file.write(reinterpret_cast<const char *>(header), 12) == 12
+              && file.write(table) == table.size();
+
+    for (size_t i = 0; ok && i < tracks.size(); i++)
+        ok = file.write(tracks[i]) == tracks[i].size();
+
+    if (!ok && error)
+        *error = file.errorString();
+
+    return ok;
+}
+
+QByteArray ImageContainer::compressTrack(const quint8 *src, int len)
+{
+    QByteArray out;
+
+    int pos = 0;
+    while (pos < len) {
+        int zeros = 0;
+        while (pos + zeros < len && src[pos + zeros] == 0 && zeros < 0xffff)
+            zeros++;
+
+        // The literal runs to the next zero run worth eliding; short
+        // runs ride along inside it.
+        const int litStart = pos + zeros;
+        int lit = 0;
+        while (litStart + lit < len && lit < 0xffff) {
+            if (src[litStart + lit] == 0) {
+                int run = 0;
+                while (litStart + lit + run < len
+                       && src[litStart + lit + run] == 0)
+                    run++;
+                if (run >= ZeroRunMin || litStart + lit + run == len)
+                    break;
+                lit += run;
+                continue;
+            }
+            lit++;
+        }
+
+        quint8 rec[4];
+        fdc::putWord(rec, quint16(zeros));
+        fdc::putWord(rec + 2, quint16(lit));
+        out.append(reinterpret_cast<const char *>(rec), 4);
+        out.append(reinterpret_cast<const char *>(src) + litStart, lit);
+
+        pos = litStart + lit;
+    }
+
+    if (out.size() == 4 && fdc::getWord(reinterpret_cast<const quint8 *>(
+                               out.constData()) + 2) == 0)
+        return QByteArray();  // all zeros
+
+    if (out.size() >= len)
+        return QByteArray(reinterpret_cast<const char *>(src), len);
+
+    return out;
+}
+
+bool ImageContainer::expandTrack(const QByteArray &stored, quint8 *dst,
+                                 int len)
+{
+    if (stored.isEmpty()) {
+        memset(dst, 0, len);
+        return true;
+    }
+
+    if (stored.size() == len) {
+        memcpy(dst, stored.constData(), len);
+        return true;
+    }
+
+    const quint8 *src = reinterpret_cast<const quint8 *>(stored.constData());
+    int in = 0;
+    int out = 0;
+
+    while (in < stored.size()) {
+        if (in + 4 > stored.size())
+            return false;
+
+        const int zeros = fdc::getWord(src + in);
+        const int lit = fdc::getWord(src + in + 2);
+        in += 4;
+
+        if (out + zeros + lit > len || in + lit > stored.size())
+            return false;
+
+        memset(dst + out, 0, zeros);
+        out += zeros;
+        memcpy(dst + out, src + in, lit);
+        out += lit;
+        in += lit;
+    }
+
+    return out == len;
+}
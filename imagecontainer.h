@@ -0,0 +1,66 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * imagecontainer.h -- compressed per-track image container
+ */
+
+#ifndef IMAGECONTAINER_H
+#define IMAGECONTAINER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+/*
+ * The .cdsk container stores an image as independently compressed
+ * tracks, so mostly-empty images (the common case in a library of
+ * system disks) shrink dramatically and the drive layer can expand a
+ * single track on first READ without touching the rest.
+ *
+ * Layout, all little endian:
+ *
+ *   bytes 0-3   magic "FDCZ"
+ *   bytes 4-5   format version (1)
+ *   bytes 6-7   track length in bytes
+ *   bytes 8-11  track count
+ *   then        track count stored lengths, 4 bytes each
+ *   then        the stored tracks, in order
+ *
+ * A stored length of zero marks an all-zero track with no stored
+ * bytes; a stored length equal to the track length marks a raw track;
+ * anything else is a zero-run stream: records of a 16 bit zero-run
+ * length, a 16 bit literal length and the literal bytes, repeated
+ * until the track is covered.  Tracks that would not shrink are kept
+ * raw, so expansion is always a single pass with no worst case.
+ */
+class ImageContainer
+{
+public:
+    // Sniffs the magic; false for plain .dsk images.
+    static bool isContainer(const QString &path);
+
+    // Reads the whole container into per-track compressed blobs (an
+    // all-zero track loads as an empty blob).
+    static bool load(const QString &path, int *trackLen, int *trackCount,
+                     std::vector<QByteArray> *tracks, QString *error);
+
+    // Writes a container from per-track compressed blobs.
+    static bool store(const QString &path, int trackLen,
+                      const std::vector<QByteArray> &tracks, QString *error);
+
+    // Compress one track.  Returns an empty array for an all-zero
+    // track and a raw copy when elision would not save anything.
+    static QByteArray compressTrack(const quint8 *src, int len);
+
+    // Expand one stored track into dst (len bytes); false on a
+    // corrupt stream.
+    static bool expandTrack(const QByteArray &stored, quint8 *dst, int len);
+
+private:
+    // Zero runs shorter than this ride along inside a literal; the
+    // record overhead would outweigh the elision.
+    static constexpr int ZeroRunMin = 8;
+};
+
+#endif // IMAGECONTAINER_H
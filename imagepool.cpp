@@ -0,0 +1,63 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * imagepool.cpp -- shared read-only image buffers, deduplicated by content
+ */
+
+#include "imagepool.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+
+QMutex ImagePool::s_lock;
+QHash<QString, QWeakPointer<SharedImage>> ImagePool::s_byPath;
+QHash<QByteArray, QWeakPointer<SharedImage>> ImagePool::s_byHash;
+
+QSharedPointer<SharedImage> ImagePool::acquire(const QString &path,
+                                               QString *error)
+{
+    const QString canonical = QFileInfo(path).canonicalFilePath();
+
+    {
+        QMutexLocker locker(&s_lock);
+
+        if (auto image = s_byPath.value(canonical).lock())
+            return image;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return {};
+    }
+
+    QByteArray data = file.readAll();
+    if (data.size() != file.size()) {
+        if (error)
+            *error = QStringLiteral("%1: short read").arg(path);
+        return {};
+    }
+
+    const QByteArray hash =
+        QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    QMutexLocker locker(&s_lock);
+
+    // Same contents under a different path: share the existing buffer
+    // and drop the one just read.
+    if (auto image = s_byHash.value(hash).lock()) {
+        s_byPath.insert(canonical, image);
+        return image;
+    }
+
+    auto image = QSharedPointer<SharedImage>::create();
+    image->path = path;
+    image->data = std::move(data);
+
+    s_byPath.insert(canonical, image);
+    s_byHash.insert(hash, image);
+
+    return image;
+}
@@ -0,0 +1,44 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * imagepool.h -- shared read-only image buffers, deduplicated by content
+ */
+
+#ifndef IMAGEPOOL_H
+#define IMAGEPOOL_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+
+/*
+ * One fully loaded, read-only disk image.  Drives mounted copy-on-write
+ * hold a shared reference; the buffer is never modified after load.
+ */
+struct SharedImage
+{
+    QString path;
+    QByteArray data;
+};
+
+/*
+ * Hands out SharedImage references deduplicated first by canonical
+ * path, then by SHA-1 of the contents, so a dozen drives booting the
+ * same system disk keep exactly one copy resident.  References are
+ * weak; an image is dropped when the last drive unmounts it.
+ */
+class ImagePool
+{
+public:
+    static QSharedPointer<SharedImage> acquire(const QString &path,
+                                               QString *error = nullptr);
+
+private:
+    static QMutex s_lock;
+    static QHash<QString, QWeakPointer<SharedImage>> s_byPath;
+    static QHash<QByteArray, QWeakPointer<SharedImage>> s_byHash;
+};
+
+#endif // IMAGEPOOL_H
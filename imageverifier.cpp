@@ -0,0 +1,115 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * imageverifier.cpp -- background image integrity verification
+ */
+
+#include "imageverifier.h"
+#include "drive.h"
+#include "fdcproto.h"
+
+#include <QCryptographicHash>
+#include <QtConcurrent/QtConcurrent>
+
+#include <numeric>
+
+ImageVerifier::ImageVerifier(Drive *drive, QObject *parent)
+    : QObject(parent)
+    , m_drive(drive)
+{
+}
+
+ImageVerifier::~ImageVerifier()
+{
+    cancel();
+}
+
+void ImageVerifier::start()
+{
+    const int tracks = m_drive->trackCount();
+    if (tracks <= 0)
+        return;
+
+    m_hashes.assign(tracks, QByteArray());
+    m_bad.clear();
+    m_done = false;
+    m_cancel.store(false);
+    m_remaining.store(tracks);
+
+    m_tracks.resize(tracks);
+    std::iota(m_tracks.begin(), m_tracks.end(), 0);
+
+    // One map job per track; the pool spreads them across cores and
+    // each job holds the drive lock only for its own track read.
+    m_future = QtConcurrent::map(m_tracks,
+                                 [this](int track) { verifyTrack(track); });
+}
+
+void ImageVerifier::cancel()
+{
+    m_cancel.store(true);
+    m_future.waitForFinished();
+}
+
+void ImageVerifier::verifyTrack(int track)
+{
+    if (!m_cancel.load(std::memory_order_relaxed)) {
+        quint8 buf[fdc::MaxTrackLen];
+
+        if (m_drive->readTrack(track, buf)) {
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            hash.addData(QByteArrayView(reinterpret_cast<const char *>(buf),
+                                        m_drive->trackLen()));
+
+            QMutexLocker locker(&m_lock);
+            m_hashes[track] = hash.result();
+        } else {
+            QMutexLocker locker(&m_lock);
+            m_bad.append(track);
+        }
+    }
+
+    if (m_remaining.fetch_sub(1) == 1) {
+        int scanned, bad;
+        {
+            QMutexLocker locker(&m_lock);
+            m_done = true;
+            std::sort(m_bad.begin(), m_bad.end());
+            scanned = int(m_hashes.size());
+            bad = int(m_bad.size());
+        }
+        emit verified(scanned, bad);
+    }
+}
+
+bool ImageVerifier::finished() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_done;
+}
+
+QList<int> ImageVerifier::badTracks() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_bad;
+}
+
+QByteArray ImageVerifier::trackHash(int track) const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (track < 0 || track >= int(m_hashes.size()))
+        return QByteArray();
+
+    return m_hashes[track];
+}
+
+void ImageVerifier::refreshTrackHash(int track, const QByteArray &hash)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (track >= 0 && track < int(m_hashes.size()))
+        m_hashes[track] = hash;
+}
@@ -0,0 +1,73 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * imageverifier.h -- background image integrity verification
+ */
+
+#ifndef IMAGEVERIFIER_H
+#define IMAGEVERIFIER_H
+
+#include <QByteArray>
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+
+#include <atomic>
+#include <vector>
+
+class Drive;
+
+/*
+ * Verifies a freshly mounted image in the background: every track is
+ * read once and its SHA-1 recorded, spread across all cores with
+ * QtConcurrent.  The drive serves requests while the pass runs --
+ * Drive access is serialized per track, so verification interleaves
+ * with live traffic instead of delaying first use.
+ *
+ * A track that cannot be read (truncated or failing media) is flagged
+ * before the FDC+ trips over it; verified() reports the tally.  The
+ * per-track hashes stay available afterwards as a reference for later
+ * integrity checks.
+ */
+class ImageVerifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageVerifier(Drive *drive, QObject *parent = nullptr);
+    ~ImageVerifier();
+
+    void start();
+    void cancel();
+
+    bool finished() const;
+    QList<int> badTracks() const;
+
+    // SHA-1 of the track as read during the pass; empty if the track
+    // was unreadable or the pass has not reached it yet.
+    QByteArray trackHash(int track) const;
+
+    // Replace the reference hash after a legitimate session write, so
+    // later integrity checks measure against the current contents.
+    void refreshTrackHash(int track, const QByteArray &hash);
+
+signals:
+    void verified(int scanned, int bad);
+
+private:
+    void verifyTrack(int track);
+
+    Drive *m_drive;
+    QFuture<void> m_future;
+    std::atomic<bool> m_cancel { false };
+    std::atomic<int> m_remaining { 0 };
+
+    mutable QMutex m_lock;
+    std::vector<QByteArray> m_hashes;
+    QList<int> m_bad;
+    bool m_done = false;
+    std::vector<int> m_tracks;
+};
+
+#endif // IMAGEVERIFIER_H
@@ -0,0 +1,105 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * latencystats.cpp -- per-command-type latency histograms
+ */
+
+#include "latencystats.h"
+
+void LatencyStats::Histogram::add(qint64 ns)
+{
+    const quint64 us = quint64(ns) / 1000;
+
+    int bucket = 0;
+    while (bucket < Buckets - 1 && (quint64(1) << bucket) <= us)
+        bucket++;
+
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+quint64 LatencyStats::Histogram::percentile(double p) const
+{
+    const quint64 total = count.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+
+    const quint64 rank = quint64(double(total) * p);
+    quint64 seen = 0;
+
+    for (int i = 0; i < Buckets; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > rank)
+            return quint64(1) << i;
+    }
+
+    return quint64(1) << (Buckets - 1);
+}
+
+void LatencyStats::record(Cmd cmd, qint64 firstByteNs, qint64 lastByteNs)
+{
+    if (firstByteNs >= 0)
+        m_first[cmd].add(firstByteNs);
+    if (lastByteNs >= 0)
+        m_last[cmd].add(lastByteNs);
+}
+
+const char *LatencyStats::cmdName(int cmd)
+{
+    switch (cmd) {
+    case Stat: return "STAT";
+    case Read: return "READ";
+    case Writ: return "WRIT";
+    }
+
+    return "?";
+}
+
+QString LatencyStats::report() const
+{
+    QString out;
+
+    for (int cmd = 0; cmd < CmdTypes; cmd++) {
+        const quint64 n = m_last[cmd].count.load(std::memory_order_relaxed);
+        if (n == 0)
+            continue;
+
+        out += QStringLiteral("%1 n=%2  first p50/p95/p99: %3/%4/%5 us  "
+                              "last: %6/%7/%8 us\n")
+                   .arg(QLatin1String(cmdName(cmd)))
+                   .arg(n)
+                   .arg(m_first[cmd].percentile(0.50))
+                   .arg(m_first[cmd].percentile(0.95))
+                   .arg(m_first[cmd].percentile(0.99))
+                   .arg(m_last[cmd].percentile(0.50))
+                   .arg(m_last[cmd].percentile(0.95))
+                   .arg(m_last[cmd].percentile(0.99));
+    }
+
+    if (out.isEmpty())
+        out = QStringLiteral("(no commands serviced)");
+
+    return out;
+}
+
+QString LatencyStats::dump() const
+{
+    QString out = QStringLiteral("command,phase,count,p50_us,p95_us,p99_us\n");
+
+    for (int cmd = 0; cmd < CmdTypes; cmd++) {
+        const Histogram *phases[] = { &m_first[cmd], &m_last[cmd] };
+        const char *names[] = { "first_byte", "last_byte" };
+
+        for (int i = 0; i < 2; i++) {
+            out += QStringLiteral("%1,%2,%3,%4,%5,%6\n")
+                       .arg(QLatin1String(cmdName(cmd)))
+                       .arg(QLatin1String(names[i]))
+                       .arg(phases[i]->count.load(std::memory_order_relaxed))
+                       .arg(phases[i]->percentile(0.50))
+                       .arg(phases[i]->percentile(0.95))
+                       .arg(phases[i]->percentile(0.99));
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,63 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * latencystats.h -- per-command-type latency histograms
+ */
+
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+
+/*
+ * Accumulates command service latency -- receipt to first response
+ * byte and receipt to last byte handed to the transport -- into
+ * power-of-two microsecond buckets, per command type.  Recording is a
+ * couple of relaxed atomic increments, cheap enough to stay on
+ * permanently at 460.8K baud; percentiles are computed only when the
+ * GUI asks.  One instance is shared by every serial worker.
+ */
+class LatencyStats
+{
+public:
+    enum Cmd {
+        Stat,
+        Read,
+        Writ,
+        CmdTypes
+    };
+
+    // Buckets cover 1 us .. ~2000 s; bucket i holds samples below
+    // 2^i microseconds.
+    static constexpr int Buckets = 32;
+
+    void record(Cmd cmd, qint64 firstByteNs, qint64 lastByteNs);
+
+    // Human readable p50/p95/p99 table for the stats pane.
+    QString report() const;
+
+    // Machine readable dump: one CSV row per command type and phase,
+    // with count and percentiles in microseconds.
+    QString dump() const;
+
+private:
+    struct Histogram {
+        std::atomic<quint64> count { 0 };
+        std::atomic<quint64> buckets[Buckets] {};
+
+        void add(qint64 ns);
+        // Approximate percentile (bucket upper bound), in microseconds.
+        quint64 percentile(double p) const;
+    };
+
+    static const char *cmdName(int cmd);
+
+    // [cmd] x {time to first byte, time to last byte}
+    Histogram m_first[CmdTypes];
+    Histogram m_last[CmdTypes];
+};
+
+#endif // LATENCYSTATS_H
@@ -0,0 +1,22 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * main.cpp -- application entry point
+ */
+
+#include <QApplication>
+
+#include "mainwindow.h"
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    QCoreApplication::setOrganizationName(QStringLiteral("Deltec"));
+    QCoreApplication::setApplicationName(QStringLiteral("fdc-sds-qt6"));
+
+    MainWindow window;
+    window.show();
+
+    return app.exec();
+}
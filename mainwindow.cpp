@@ -0,0 +1,819 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * mainwindow.cpp -- main window
+ */
+
+#include "flushthread.h"
+#include "imageverifier.h"
+#include "mainwindow.h"
+#include "scrubthread.h"
+#include "serialworker.h"
+#include "settingsdialog.h"
+#include "writejournal.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QFile>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSettings>
+#include <QSpinBox>
+#include <QStatusBar>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrent>
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent)
+{
+    for (int i = 0; i < DriveCount; i++)
+        m_caches[i] = new TrackCache(&m_drives[i]);
+
+    buildUi();
+
+    // Unparented: the destructor tears it down explicitly, after the
+    // serial threads have stopped and before the drives go away.
+    m_journal = new WriteJournal;
+    m_journal->start();
+
+    m_flusher = new FlushThread(&m_drives, DriveCount);
+    m_flusher->start(QThread::LowPriority);
+
+    m_scrubber = new ScrubThread(&m_drives, m_caches, DriveCount,
+                                 &m_engineStatus);
+    connect(m_scrubber, &ScrubThread::mismatch,
+            this, [this](int unit, int track, bool repaired) {
+        statusBar()->showMessage(
+            repaired
+                ? tr("Drive %1: track %2 corrupted, restored from master")
+                      .arg(unit).arg(track)
+                : tr("Drive %1: track %2 corrupted, no master copy to "
+                     "restore from").arg(unit).arg(track),
+            10000);
+    });
+    m_scrubber->start(QThread::LowPriority);
+
+    // Pick up where the last session left off: remount, reopen, and
+    // warm the caches in the background.
+    restoreSession();
+}
+
+MainWindow::~MainWindow()
+{
+    saveSession();
+
+    closePorts();
+
+    // With every link closed nothing references a retired drive;
+    // settle any swap still waiting for quiescence.
+    processRetired();
+
+    // The scrubber reads drives and verifiers; stop it before either
+    // goes away.
+    delete m_scrubber;
+
+    // Drains any journaled writes before the drives are destroyed.
+    delete m_journal;
+    delete m_flusher;
+
+    for (int i = 0; i < DriveCount; i++) {
+        delete m_standbyVerifiers[i];
+        delete m_standby[i];
+        delete m_caches[i];
+    }
+}
+
+void MainWindow::buildUi()
+{
+    auto *central = new QWidget(this);
+    auto *mainLayout = new QVBoxLayout(central);
+
+    auto *portLayout = new QHBoxLayout;
+
+    m_settingsButton = new QPushButton(tr("Ports..."));
+    connect(m_settingsButton, &QPushButton::clicked,
+            this, &MainWindow::configurePorts);
+    portLayout->addWidget(m_settingsButton);
+
+    m_openButton = new QPushButton(tr("Open"));
+    connect(m_openButton, &QPushButton::clicked, this, &MainWindow::openPorts);
+    portLayout->addWidget(m_openButton);
+
+    m_closeButton = new QPushButton(tr("Close"));
+    m_closeButton->setEnabled(false);
+    connect(m_closeButton, &QPushButton::clicked, this, &MainWindow::closePorts);
+    portLayout->addWidget(m_closeButton);
+
+    m_linksLabel = new QLabel(tr("Links: none"));
+    portLayout->addWidget(m_linksLabel);
+
+    portLayout->addStretch();
+    mainLayout->addLayout(portLayout);
+
+    m_linkStatsLabel = new QLabel;
+    m_linkStatsLabel->setFont(QFont(QStringLiteral("monospace")));
+    mainLayout->addWidget(m_linkStatsLabel);
+
+    for (int i = 0; i < DriveCount; i++) {
+        auto *box = new QGroupBox(tr("Drive %1").arg(i));
+        auto *grid = new QGridLayout(box);
+
+        m_fileLabel[i] = new QLabel(tr("(not mounted)"));
+        grid->addWidget(m_fileLabel[i], 0, 0, 1, 2);
+
+        m_trackLabel[i] = new QLabel(tr("Track: -"));
+        grid->addWidget(m_trackLabel[i], 1, 0);
+
+        m_cacheLabel[i] = new QLabel(tr("Cache: 0 hits / 0 misses"));
+        grid->addWidget(m_cacheLabel[i], 1, 1);
+
+        m_ioLabel[i] = new QLabel(tr("I/O: -"));
+        grid->addWidget(m_ioLabel[i], 5, 0, 1, 2);
+
+        m_mountButton[i] = new QPushButton(tr("Mount..."));
+        m_mountButton[i]->setProperty("unit", i);
+        connect(m_mountButton[i], &QPushButton::clicked,
+                this, &MainWindow::mountClicked);
+        grid->addWidget(m_mountButton[i], 2, 0);
+
+        m_unmountButton[i] = new QPushButton(tr("Unmount"));
+        m_unmountButton[i]->setProperty("unit", i);
+        m_unmountButton[i]->setEnabled(false);
+        connect(m_unmountButton[i], &QPushButton::clicked,
+                this, &MainWindow::unmountClicked);
+        grid->addWidget(m_unmountButton[i], 2, 1);
+
+        m_backendBox[i] = new QComboBox;
+        m_backendBox[i]->addItem(tr("Buffered"),
+                                 int(Drive::Backend::Buffered));
+        m_backendBox[i]->addItem(tr("Memory-mapped"),
+                                 int(Drive::Backend::Mapped));
+        m_backendBox[i]->addItem(tr("Shared (copy-on-write)"),
+                                 int(Drive::Backend::Shared));
+        m_backendBox[i]->addItem(tr("Pinned to RAM"),
+                                 int(Drive::Backend::Pinned));
+        m_backendBox[i]->addItem(tr("Overlay (pristine master)"),
+                                 int(Drive::Backend::Overlay));
+        m_backendBox[i]->setToolTip(tr("How the image is backed: buffered "
+                                       "QFile I/O, a zero-copy file mapping, "
+                                       "or a read-only buffer shared between "
+                                       "drives mounting identical images"));
+        grid->addWidget(m_backendBox[i], 3, 0);
+
+        m_wbCheck[i] = new QCheckBox(tr("Write-behind"));
+        m_wbCheck[i]->setToolTip(tr("Acknowledge WRIT once journaled; "
+                                    "commit to the image in batches"));
+        grid->addWidget(m_wbCheck[i], 3, 1);
+
+        m_saveButton[i] = new QPushButton(tr("Save"));
+        m_saveButton[i]->setProperty("unit", i);
+        m_saveButton[i]->setEnabled(false);
+        m_saveButton[i]->setToolTip(tr("Incremental save: rewrite only the "
+                                       "tracks dirtied this session"));
+        connect(m_saveButton[i], &QPushButton::clicked,
+                this, &MainWindow::saveClicked);
+        grid->addWidget(m_saveButton[i], 4, 1);
+
+        m_stageButton[i] = new QPushButton(tr("Stage..."));
+        m_stageButton[i]->setProperty("unit", i);
+        m_stageButton[i]->setToolTip(tr("Load and verify a standby image "
+                                        "in the background, ready to swap "
+                                        "in"));
+        connect(m_stageButton[i], &QPushButton::clicked,
+                this, &MainWindow::stageClicked);
+        grid->addWidget(m_stageButton[i], 6, 0);
+
+        m_swapButton[i] = new QPushButton(tr("Swap"));
+        m_swapButton[i]->setProperty("unit", i);
+        m_swapButton[i]->setEnabled(false);
+        m_swapButton[i]->setToolTip(tr("Serve the staged image from the "
+                                       "next command on; the current image "
+                                       "is retired"));
+        connect(m_swapButton[i], &QPushButton::clicked,
+                this, &MainWindow::swapClicked);
+        grid->addWidget(m_swapButton[i], 6, 1);
+
+        auto *ilLayout = new QHBoxLayout;
+        ilLayout->addWidget(new QLabel(tr("Interleave:")));
+        m_interleaveBox[i] = new QSpinBox;
+        m_interleaveBox[i]->setRange(1, 8);
+        m_interleaveBox[i]->setToolTip(tr("Emit sectors in this physical "
+                                          "interleave order; 1 is "
+                                          "sequential"));
+        ilLayout->addWidget(m_interleaveBox[i]);
+        m_verifyCheck[i] = new QCheckBox(tr("Verify"));
+        m_verifyCheck[i]->setToolTip(tr("Hash every track in the background "
+                                        "after mounting and flag unreadable "
+                                        "ones; serving starts immediately"));
+        ilLayout->addWidget(m_verifyCheck[i]);
+        ilLayout->addStretch();
+        grid->addLayout(ilLayout, 4, 0);
+
+        mainLayout->addWidget(box);
+    }
+
+    auto *statsBox = new QGroupBox(tr("Latency"));
+    auto *statsLayout = new QHBoxLayout(statsBox);
+    m_statsLabel = new QLabel(tr("(no commands serviced)"));
+    m_statsLabel->setFont(QFont(QStringLiteral("monospace")));
+    statsLayout->addWidget(m_statsLabel, 1);
+    auto *dumpButton = new QPushButton(tr("Dump..."));
+    connect(dumpButton, &QPushButton::clicked, this, &MainWindow::dumpStats);
+    statsLayout->addWidget(dumpButton);
+    auto *drivesButton = new QPushButton(tr("Drives..."));
+    drivesButton->setToolTip(tr("Export the per-drive operation ledger "
+                                "as CSV"));
+    connect(drivesButton, &QPushButton::clicked,
+            this, &MainWindow::dumpDriveStats);
+    statsLayout->addWidget(drivesButton);
+    auto *traceButton = new QPushButton(tr("Trace..."));
+    traceButton->setToolTip(tr("Dump the flight recorder's recent "
+                               "command/response window as a binary "
+                               "trace"));
+    connect(traceButton, &QPushButton::clicked,
+            this, &MainWindow::dumpTrace);
+    statsLayout->addWidget(traceButton);
+    mainLayout->addWidget(statsBox);
+
+    auto *statsTimer = new QTimer(this);
+    connect(statsTimer, &QTimer::timeout, this, &MainWindow::refreshStats);
+    statsTimer->start(1000);
+
+    // 30 Hz status sampling: the engines update EngineStatus in place
+    // with no per-command signals; this timer coalesces everything that
+    // happened since the last tick into at most one repaint per label.
+    auto *statusTimer = new QTimer(this);
+    connect(statusTimer, &QTimer::timeout, this, &MainWindow::sampleStatus);
+    statusTimer->start(33);
+
+    // Runs only while a retired drive is waiting for the engines to
+    // quiesce; stops itself once the list empties.
+    m_retireTimer = new QTimer(this);
+    connect(m_retireTimer, &QTimer::timeout,
+            this, &MainWindow::processRetired);
+    m_retireTimer->setInterval(50);
+
+    setCentralWidget(central);
+    setWindowTitle(tr("FDC+ Serial Drive Server"));
+}
+
+void MainWindow::configurePorts()
+{
+    SettingsDialog dialog(this);
+    dialog.exec();
+}
+
+void MainWindow::openPorts()
+{
+    QSettings settings;
+    const QStringList ports =
+        settings.value(QStringLiteral("ports")).toStringList();
+    const int baud = settings.value(QStringLiteral("baud"), 403200).toInt();
+
+    if (ports.isEmpty()) {
+        QMessageBox::information(this, tr("Serial Links"),
+                                 tr("No ports configured."));
+        return;
+    }
+
+    m_openButton->setEnabled(false);
+    m_settingsButton->setEnabled(false);
+
+    // One protocol engine per link, each on its own thread, all sharing
+    // the same drives and caches so a common image is resident once.
+    for (const QString &name : ports) {
+        auto *thread = new QThread(this);
+        auto *worker = new SerialWorker(&m_drives, m_caches, m_journal,
+                                        &m_stats, m_driveStats,
+                                        &m_engineStatus, &m_recorder);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+
+        connect(worker, &SerialWorker::portOpened,
+                this, &MainWindow::portOpened);
+        connect(worker, &SerialWorker::linkStats,
+                this, &MainWindow::linkStats);
+
+        thread->start();
+
+        QMetaObject::invokeMethod(worker, [worker, name, baud] {
+            worker->openPort(name, baud);
+        }, Qt::QueuedConnection);
+
+        m_portThreads.append(thread);
+        m_workers.append(worker);
+    }
+
+    m_closeButton->setEnabled(true);
+}
+
+void MainWindow::closePorts()
+{
+    for (SerialWorker *worker : std::as_const(m_workers))
+        QMetaObject::invokeMethod(worker, &SerialWorker::closePort,
+                                  Qt::BlockingQueuedConnection);
+
+    for (QThread *thread : std::as_const(m_portThreads)) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+
+    m_portThreads.clear();
+    m_workers.clear();
+    m_openLinks = 0;
+
+    updateLinkLabel();
+    m_openButton->setEnabled(true);
+    m_settingsButton->setEnabled(true);
+    m_closeButton->setEnabled(false);
+}
+
+void MainWindow::portOpened(bool ok, const QString &name, const QString &error)
+{
+    if (!ok) {
+        QMessageBox::warning(this, tr("Serial Port"),
+                             tr("Cannot open %1: %2").arg(name, error));
+        return;
+    }
+
+    m_openLinks++;
+    updateLinkLabel();
+}
+
+void MainWindow::linkStats(const QString &name, double rxBps, double txBps,
+                           int crcErrors, int baud)
+{
+    m_linkStats.insert(name,
+                       tr("%1 @%2: rx %3 B/s tx %4 B/s crc errs %5")
+                           .arg(name)
+                           .arg(baud)
+                           .arg(qint64(rxBps))
+                           .arg(qint64(txBps))
+                           .arg(crcErrors));
+
+    QStringList lines = m_linkStats.values();
+    lines.sort();
+    m_linkStatsLabel->setText(lines.join(QLatin1Char('\n')));
+}
+
+void MainWindow::updateLinkLabel()
+{
+    if (m_openLinks == 0)
+        m_linksLabel->setText(tr("Links: none"));
+    else
+        m_linksLabel->setText(tr("Links: %1 open").arg(m_openLinks));
+}
+
+void MainWindow::sampleStatus()
+{
+    for (int i = 0; i < DriveCount; i++) {
+        const quint64 ops =
+            m_engineStatus.drives[i].ops.load(std::memory_order_relaxed);
+        if (ops == m_shownOps[i])
+            continue;
+        m_shownOps[i] = ops;
+
+        const int track =
+            m_engineStatus.drives[i].track.load(std::memory_order_relaxed);
+        if (track != m_shownTrack[i]) {
+            m_shownTrack[i] = track;
+            m_trackLabel[i]->setText(tr("Track: %1").arg(track));
+        }
+    }
+}
+
+void MainWindow::updateDrivePanel(int unit)
+{
+    // Pinned mounts register immediately and fill in the background;
+    // show the loader's progress until the arena is complete.
+    if (m_drives[unit].isMounted()) {
+        const int percent = m_drives[unit].loadPercent();
+        m_fileLabel[unit]->setText(
+            percent < 100
+                ? tr("%1 (loading %2%)")
+                      .arg(m_drives[unit].fileName())
+                      .arg(percent)
+                : m_drives[unit].fileName());
+    }
+
+    m_cacheLabel[unit]->setText(tr("Cache: %1 hits / %2 misses")
+                                    .arg(m_caches[unit]->hits())
+                                    .arg(m_caches[unit]->misses()));
+
+    const DriveStats &stats = m_driveStats[unit];
+    m_ioLabel[unit]->setText(
+        tr("I/O: %1 reads / %2 writes, %3 retries, %4 crc, %5 KB moved")
+            .arg(stats.reads.load(std::memory_order_relaxed))
+            .arg(stats.writes.load(std::memory_order_relaxed))
+            .arg(stats.retries.load(std::memory_order_relaxed))
+            .arg(stats.crcFailures.load(std::memory_order_relaxed))
+            .arg((stats.bytesRead.load(std::memory_order_relaxed)
+                  + stats.bytesWritten.load(std::memory_order_relaxed))
+                 / 1024));
+}
+
+void MainWindow::refreshStats()
+{
+    m_statsLabel->setText(m_stats.report());
+
+    // Sampling at 1 Hz keeps the engine threads free of GUI traffic;
+    // the ledgers are just relaxed counters.
+    for (int i = 0; i < DriveCount; i++)
+        updateDrivePanel(i);
+}
+
+void MainWindow::dumpStats()
+{
+    const QString path = QFileDialog::getSaveFileName(
+        this, tr("Dump Latency Statistics"), QStringLiteral("latency.csv"),
+        tr("CSV Files (*.csv);;All Files (*)"));
+    if (path.isEmpty())
+        return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("Dump"), file.errorString());
+        return;
+    }
+
+    QTextStream(&file) << m_stats.dump();
+}
+
+void MainWindow::dumpDriveStats()
+{
+    const QString path = QFileDialog::getSaveFileName(
+        this, tr("Export Drive Statistics"), QStringLiteral("drives.csv"),
+        tr("CSV Files (*.csv);;All Files (*)"));
+    if (path.isEmpty())
+        return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("Export"), file.errorString());
+        return;
+    }
+
+    QTextStream out(&file);
+    out << DriveStats::csvHeader();
+    for (int i = 0; i < DriveCount; i++)
+        out << m_driveStats[i].csvRow(i, m_caches[i]->hits(),
+                                      m_caches[i]->misses());
+}
+
+void MainWindow::dumpTrace()
+{
+    const QString path = QFileDialog::getSaveFileName(
+        this, tr("Dump Protocol Trace"), QStringLiteral("trace.fdcr"),
+        tr("Trace Files (*.fdcr);;All Files (*)"));
+    if (path.isEmpty())
+        return;
+
+    QString error;
+    if (!m_recorder.dump(path, &error))
+        QMessageBox::warning(this, tr("Trace"), error);
+}
+
+void MainWindow::mountClicked()
+{
+    const int unit = sender()->property("unit").toInt();
+
+    const QString path = QFileDialog::getOpenFileName(
+        this, tr("Mount Disk Image"), QString(),
+        tr("Disk Images (*.dsk *.cdsk);;All Files (*)"));
+    if (path.isEmpty())
+        return;
+
+    mountImage(unit, path);
+}
+
+bool MainWindow::mountImage(int unit, const QString &path)
+{
+    const Drive::Backend backend =
+        Drive::Backend(m_backendBox[unit]->currentData().toInt());
+
+    // Mount into a fresh drive and exchange it into the slot; a
+    // remount over a live image must not unmount in place while an
+    // engine may still be transmitting from its storage, so the old
+    // drive goes through the same deferred retirement as a hot swap.
+    auto *next = new Drive;
+
+    QString error;
+    if (!next->mount(path, backend, &error)) {
+        delete next;
+        QMessageBox::warning(this, tr("Mount"), error);
+        return false;
+    }
+
+    next->setWriteBehind(m_wbCheck[unit]->isChecked());
+    next->setInterleave(m_interleaveBox[unit]->value());
+
+    // Drive change: anything still journaled belongs to the old image.
+    m_journal->flushDrive(&m_drives[unit]);
+
+    Drive *prev = m_drives.exchange(unit, next);
+    m_caches[unit]->setDrive(next);
+    m_caches[unit]->clear();
+    m_driveStats[unit].reset();
+
+    // Even an unmounted predecessor is retired rather than deleted; an
+    // engine answering STAT may hold a reference loaded from the slot.
+    retireDrive(unit, prev);
+
+    m_scrubber->setVerifier(unit, nullptr);
+    delete m_verifiers[unit];
+    m_verifiers[unit] = nullptr;
+
+    if (m_verifyCheck[unit]->isChecked()) {
+        m_verifiers[unit] = new ImageVerifier(&m_drives[unit], this);
+        connect(m_verifiers[unit], &ImageVerifier::verified,
+                this, [this, unit](int scanned, int bad) {
+            if (bad > 0)
+                QMessageBox::warning(this, tr("Verify"),
+                                     tr("Drive %1: %2 of %3 tracks "
+                                        "unreadable")
+                                         .arg(unit).arg(bad).arg(scanned));
+            else
+                statusBar()->showMessage(
+                    tr("Drive %1: %2 tracks verified").arg(unit).arg(scanned),
+                    5000);
+        });
+        m_verifiers[unit]->start();
+        m_scrubber->setVerifier(unit, m_verifiers[unit]);
+    }
+
+    m_fileLabel[unit]->setText(path);
+    m_mountButton[unit]->setEnabled(false);
+    m_unmountButton[unit]->setEnabled(true);
+    m_saveButton[unit]->setEnabled(true);
+
+    return true;
+}
+
+void MainWindow::saveSession()
+{
+    QSettings settings;
+
+    settings.beginWriteArray(QStringLiteral("session/drives"), DriveCount);
+    for (int i = 0; i < DriveCount; i++) {
+        settings.setArrayIndex(i);
+        settings.setValue(QStringLiteral("path"),
+                          m_drives[i].isMounted() ? m_drives[i].fileName()
+                                                  : QString());
+        settings.setValue(QStringLiteral("backend"),
+                          m_backendBox[i]->currentIndex());
+        settings.setValue(QStringLiteral("writeBehind"),
+                          m_wbCheck[i]->isChecked());
+        settings.setValue(QStringLiteral("verify"),
+                          m_verifyCheck[i]->isChecked());
+        settings.setValue(QStringLiteral("interleave"),
+                          m_interleaveBox[i]->value());
+
+        // Residency hints: which tracks were hot when we went down.
+        QStringList hot;
+        const QList<int> resident = m_caches[i]->residentTracks();
+        for (int track : resident)
+            hot.append(QString::number(track));
+        settings.setValue(QStringLiteral("hotTracks"), hot);
+    }
+    settings.endArray();
+
+    settings.setValue(QStringLiteral("session/linksOpen"), m_openLinks > 0);
+}
+
+void MainWindow::restoreSession()
+{
+    QSettings settings;
+
+    // Links first: a STAT gets answered within the first event loop
+    // turns, while the images below are still mounting and warming.
+    if (settings.value(QStringLiteral("session/linksOpen"), false).toBool()
+        && !settings.value(QStringLiteral("ports")).toStringList().isEmpty())
+        openPorts();
+
+    const int count =
+        settings.beginReadArray(QStringLiteral("session/drives"));
+
+    for (int i = 0; i < count && i < DriveCount; i++) {
+        settings.setArrayIndex(i);
+
+        m_backendBox[i]->setCurrentIndex(
+            settings.value(QStringLiteral("backend"), 0).toInt());
+        m_wbCheck[i]->setChecked(
+            settings.value(QStringLiteral("writeBehind"), false).toBool());
+        m_verifyCheck[i]->setChecked(
+            settings.value(QStringLiteral("verify"), false).toBool());
+        m_interleaveBox[i]->setValue(
+            settings.value(QStringLiteral("interleave"), 1).toInt());
+
+        const QString path =
+            settings.value(QStringLiteral("path")).toString();
+        if (path.isEmpty() || !QFile::exists(path) || !mountImage(i, path))
+            continue;
+
+        // Warm the cache with last session's hot tracks, off the GUI
+        // thread; STAT and READ are already being answered meanwhile.
+        const QStringList hot =
+            settings.value(QStringLiteral("hotTracks")).toStringList();
+        if (!hot.isEmpty()) {
+            TrackCache *cache = m_caches[i];
+            (void)QtConcurrent::run([cache, hot] {
+                for (const QString &s : hot) {
+                    QByteArray data;
+                    cache->getTrack(s.toInt(), data);
+                }
+            });
+        }
+    }
+    settings.endArray();
+}
+
+void MainWindow::unmountClicked()
+{
+    const int unit = sender()->property("unit").toInt();
+
+    m_scrubber->setVerifier(unit, nullptr);
+    delete m_verifiers[unit];
+    m_verifiers[unit] = nullptr;
+
+    // Unmounting in place would free storage the engines may still be
+    // transmitting from; exchange in a fresh empty drive (the unit
+    // answers NOT from the next command on) and defer the real
+    // unmount like a hot swap does.
+    m_journal->flushDrive(&m_drives[unit]);
+    auto *next = new Drive;
+    Drive *prev = m_drives.exchange(unit, next);
+    m_caches[unit]->setDrive(next);
+    m_caches[unit]->clear();
+    retireDrive(unit, prev);
+
+    m_fileLabel[unit]->setText(tr("(not mounted)"));
+    m_trackLabel[unit]->setText(tr("Track: -"));
+    m_engineStatus.drives[unit].track.store(-1, std::memory_order_relaxed);
+    m_shownTrack[unit] = -1;
+    m_mountButton[unit]->setEnabled(true);
+    m_unmountButton[unit]->setEnabled(false);
+    m_saveButton[unit]->setEnabled(false);
+}
+
+void MainWindow::saveClicked()
+{
+    const int unit = sender()->property("unit").toInt();
+
+    // Journaled writes have to land in the drive before the save can
+    // see them as dirty tracks.
+    m_journal->flushDrive(&m_drives[unit]);
+
+    QString error;
+    if (!m_drives[unit].save(&error))
+        QMessageBox::warning(this, tr("Save"), error);
+}
+
+void MainWindow::stageClicked()
+{
+    const int unit = sender()->property("unit").toInt();
+
+    const QString path = QFileDialog::getOpenFileName(
+        this, tr("Stage Standby Image"), QString(),
+        tr("Disk Images (*.dsk *.cdsk);;All Files (*)"));
+    if (path.isEmpty())
+        return;
+
+    // Restage: retire any previous standby first.
+    delete m_standbyVerifiers[unit];
+    m_standbyVerifiers[unit] = nullptr;
+    if (!m_standby[unit])
+        m_standby[unit] = new Drive;
+    else
+        m_standby[unit]->unmount();
+
+    const Drive::Backend backend =
+        Drive::Backend(m_backendBox[unit]->currentData().toInt());
+
+    QString error;
+    if (!m_standby[unit]->mount(path, backend, &error)) {
+        QMessageBox::warning(this, tr("Stage"), error);
+        return;
+    }
+
+    m_standby[unit]->setWriteBehind(m_wbCheck[unit]->isChecked());
+    m_standby[unit]->setInterleave(m_interleaveBox[unit]->value());
+
+    // Verify in the background while the active image keeps serving;
+    // the hashes carry over as the scrub reference after the swap.
+    if (m_verifyCheck[unit]->isChecked()) {
+        m_standbyVerifiers[unit] = new ImageVerifier(m_standby[unit], this);
+        m_standbyVerifiers[unit]->start();
+    }
+
+    m_swapButton[unit]->setEnabled(true);
+    statusBar()->showMessage(
+        tr("Drive %1: staged %2").arg(unit).arg(path), 5000);
+}
+
+void MainWindow::swapClicked()
+{
+    const int unit = sender()->property("unit").toInt();
+
+    Drive *next = m_standby[unit];
+    if (!next || !next->isMounted())
+        return;
+
+    // Drain writes bound for the retiring image while it still serves.
+    m_journal->flushDrive(&m_drives[unit]);
+
+    // The microseconds: from the next command on, this unit serves the
+    // staged image.
+    Drive *prev = m_drives.exchange(unit, next);
+
+    m_caches[unit]->setDrive(next);
+    m_caches[unit]->clear();
+
+    // The standby's verifier becomes the scrub reference.
+    m_scrubber->setVerifier(unit, nullptr);
+    delete m_verifiers[unit];
+    m_verifiers[unit] = m_standbyVerifiers[unit];
+    m_standbyVerifiers[unit] = nullptr;
+    if (m_verifiers[unit])
+        m_scrubber->setVerifier(unit, m_verifiers[unit]);
+
+    // Retire the old image; its unmount waits for the engines to
+    // quiesce (retireDrive()).
+    m_standby[unit] = nullptr;
+    retireDrive(unit, prev);
+
+    m_driveStats[unit].reset();
+    m_engineStatus.drives[unit].track.store(-1, std::memory_order_relaxed);
+    m_shownTrack[unit] = -1;
+    m_fileLabel[unit]->setText(next->fileName());
+    m_mountButton[unit]->setEnabled(false);
+    m_unmountButton[unit]->setEnabled(true);
+    m_saveButton[unit]->setEnabled(true);
+    m_swapButton[unit]->setEnabled(false);
+
+    statusBar()->showMessage(
+        tr("Drive %1: swapped to %2").arg(unit).arg(next->fileName()), 5000);
+}
+
+// Take a drive just exchanged out of the slot table out of service.
+// An engine may still be executing a command it loaded from the old
+// slot, and the transmit rings may hold zero-copy segments pointing
+// into the image's storage, so the unmount is deferred: the drive is
+// tagged with each open link's command mark and processRetired()
+// unmounts it once every one of them has moved past that mark with
+// its transmit ring written out.
+void MainWindow::retireDrive(int unit, Drive *prev)
+{
+    RetiredDrive retired { prev, unit, {} };
+    for (SerialWorker *worker : std::as_const(m_workers))
+        retired.marks.insert(worker, worker->commandMark());
+    m_retired.append(retired);
+    m_retireTimer->start();
+}
+
+void MainWindow::processRetired()
+{
+    for (int i = m_retired.size() - 1; i >= 0; i--) {
+        const RetiredDrive &r = m_retired.at(i);
+
+        // A worker absent from the current list had its engine stopped
+        // and its rings drained; only links still open can hold a
+        // reference.
+        bool quiet = true;
+        for (SerialWorker *worker : std::as_const(m_workers)) {
+            const auto it = r.marks.constFind(worker);
+            if (it != r.marks.constEnd()
+                && !worker->quiescedSince(it.value())) {
+                quiet = false;
+                break;
+            }
+        }
+        if (!quiet)
+            continue;
+
+        RetiredDrive done = m_retired.takeAt(i);
+
+        // A write-behind WRIT in flight at the swap may have journaled
+        // against the old drive after the pre-swap flush.
+        m_journal->flushDrive(done.drive);
+        done.drive->unmount();
+
+        // The freed object becomes the next staging slot, unless a new
+        // stage already claimed one.
+        if (!m_standby[done.unit])
+            m_standby[done.unit] = done.drive;
+        else
+            delete done.drive;
+    }
+
+    if (m_retired.isEmpty())
+        m_retireTimer->stop();
+}
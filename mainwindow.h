@@ -0,0 +1,140 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * mainwindow.h -- main window
+ */
+
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QHash>
+#include <QList>
+#include <QMainWindow>
+
+#include "drive.h"
+#include "drivestats.h"
+#include "drivetable.h"
+#include "enginestatus.h"
+#include "fdcproto.h"
+#include "flightrecorder.h"
+#include "latencystats.h"
+#include "trackcache.h"
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QThread;
+class QTimer;
+class FlushThread;
+class ImageVerifier;
+class ScrubThread;
+class SerialWorker;
+class WriteJournal;
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DriveCount = fdc::DriveCount;
+
+    explicit MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
+
+private slots:
+    void configurePorts();
+    void openPorts();
+    void closePorts();
+    void portOpened(bool ok, const QString &name, const QString &error);
+    void linkStats(const QString &name, double rxBps, double txBps,
+                   int crcErrors, int baud);
+    void sampleStatus();
+    void mountClicked();
+    void unmountClicked();
+    void saveClicked();
+    void stageClicked();
+    void swapClicked();
+    void refreshStats();
+    void dumpStats();
+    void dumpDriveStats();
+    void dumpTrace();
+    void processRetired();
+
+private:
+    void buildUi();
+    bool mountImage(int unit, const QString &path);
+    void retireDrive(int unit, Drive *prev);
+    void saveSession();
+    void restoreSession();
+    void updateDrivePanel(int unit);
+    void updateLinkLabel();
+
+    // One protocol engine per configured serial port, each on its own
+    // thread; all of them share the drives, caches and journal below.
+    QList<QThread *> m_portThreads;
+    QList<SerialWorker *> m_workers;
+    int m_openLinks = 0;
+
+    WriteJournal *m_journal;
+    FlushThread *m_flusher;
+    ScrubThread *m_scrubber;
+    LatencyStats m_stats;
+
+    // Atomic slot table the engines serve from; hot swaps exchange a
+    // slot's pointer between commands.
+    DriveTable m_drives;
+    TrackCache *m_caches[DriveCount];
+    DriveStats m_driveStats[DriveCount];
+
+    // Standby slot per drive: an image staged in the background, ready
+    // to swap in.  The drive retired by a swap becomes the next
+    // staging object -- but only once every engine that may still hold
+    // a pointer into it has quiesced (see processRetired()).
+    Drive *m_standby[DriveCount] = {};
+    ImageVerifier *m_standbyVerifiers[DriveCount] = {};
+
+    // Drives retired by a swap, each tagged with a per-worker command
+    // mark; unmounted once every link open at swap time has passed that
+    // mark with an empty transmit ring.
+    struct RetiredDrive {
+        Drive *drive;
+        int unit;
+        QHash<SerialWorker *, quint64> marks;
+    };
+    QList<RetiredDrive> m_retired;
+    QTimer *m_retireTimer;
+
+    // Engines write here in place; sampleStatus() reads it at 30 Hz
+    // and repaints only what changed since the last sample.
+    EngineStatus m_engineStatus;
+    FlightRecorder m_recorder;
+    int m_shownTrack[DriveCount] = {};
+    quint64 m_shownOps[DriveCount] = {};
+    ImageVerifier *m_verifiers[DriveCount] = {};
+
+    QPushButton *m_settingsButton;
+    QPushButton *m_openButton;
+    QPushButton *m_closeButton;
+    QLabel *m_linksLabel;
+    QLabel *m_statsLabel;
+    QLabel *m_linkStatsLabel;
+    QHash<QString, QString> m_linkStats;
+
+    QLabel *m_fileLabel[DriveCount];
+    QLabel *m_trackLabel[DriveCount];
+    QLabel *m_cacheLabel[DriveCount];
+    QLabel *m_ioLabel[DriveCount];
+    QPushButton *m_mountButton[DriveCount];
+    QPushButton *m_unmountButton[DriveCount];
+    QPushButton *m_saveButton[DriveCount];
+    QPushButton *m_stageButton[DriveCount];
+    QPushButton *m_swapButton[DriveCount];
+    QComboBox *m_backendBox[DriveCount];
+    QCheckBox *m_wbCheck[DriveCount];
+    QCheckBox *m_verifyCheck[DriveCount];
+    QSpinBox *m_interleaveBox[DriveCount];
+};
+
+#endif // MAINWINDOW_H
@@ -0,0 +1,79 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * ringbuffer.h -- fixed-capacity receive ring buffer
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QtGlobal>
+
+#include <cstring>
+#include <vector>
+
+/*
+ * Byte ring sized once at startup; the receive path reads from the
+ * serial port straight into the ring and the parser frames messages in
+ * place, so steady-state serving touches the allocator not at all.
+ *
+ * Single-threaded use only: filled and drained on the worker thread.
+ */
+class RingBuffer
+{
+public:
+    explicit RingBuffer(int capacity)
+        : m_buf(capacity)
+    {
+    }
+
+    int size() const { return m_size; }
+    int capacity() const { return int(m_buf.size()); }
+
+    // Contiguous free region at the tail, for reading from the port
+    // directly into the ring.  Returns its length, which is zero when
+    // the ring is full.
+    int contiguousFree(char **ptr)
+    {
+        const int cap = capacity();
+        const int tail = (m_head + m_size) % cap;
+        const int free = cap - m_size;
+
+        *ptr = reinterpret_cast<char *>(m_buf.data()) + tail;
+
+        return qMin(free, cap - tail);
+    }
+
+    void commitWrite(int len) { m_size += len; }
+
+    // Copy len bytes starting at offset into dst without consuming.
+    void peek(quint8 *dst, int offset, int len) const
+    {
+        const int cap = capacity();
+        const int start = (m_head + offset) % cap;
+        const int first = qMin(len, cap - start);
+
+        memcpy(dst, m_buf.data() + start, first);
+        if (first < len)
+            memcpy(dst + first, m_buf.data(), len - first);
+    }
+
+    void consume(int len)
+    {
+        m_head = (m_head + len) % capacity();
+        m_size -= len;
+    }
+
+    void clear()
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+private:
+    std::vector<quint8> m_buf;
+    int m_head = 0;
+    int m_size = 0;
+};
+
+#endif // RINGBUFFER_H
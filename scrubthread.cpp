@@ -0,0 +1,130 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * scrubthread.cpp -- idle-time verify-and-scrub of mounted images
+ */
+
+#include "scrubthread.h"
+#include "drive.h"
+#include "drivetable.h"
+#include "enginestatus.h"
+#include "fdcproto.h"
+#include "imageverifier.h"
+#include "trackcache.h"
+
+#include <QCryptographicHash>
+
+static QByteArray hashTrack(const quint8 *buf, int len)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(buf), len));
+
+    return hash.result();
+}
+
+ScrubThread::ScrubThread(DriveTable *drives, TrackCache *const *caches,
+                         int count,
+                         const EngineStatus *status, QObject *parent)
+    : QThread(parent)
+    , m_drives(drives)
+    , m_caches(caches)
+    , m_count(count)
+    , m_status(status)
+    , m_verifiers(count, nullptr)
+{
+}
+
+ScrubThread::~ScrubThread()
+{
+    m_stop.store(true);
+    wait();
+}
+
+void ScrubThread::setVerifier(int unit, ImageVerifier *verifier)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_verifiers[unit] = verifier;
+    m_unit = unit;
+    m_track = 0;
+}
+
+void ScrubThread::run()
+{
+    while (!m_stop.load()) {
+        msleep(PassIntervalMs);
+
+        if (m_status->idleMs() < IdleThresholdMs)
+            continue;
+
+        for (int i = 0; i < TracksPerPass && !m_stop.load(); i++) {
+            // Stand down the moment traffic resumes.
+            if (m_status->idleMs() < IdleThresholdMs)
+                break;
+
+            if (!scrubOne())
+                break;
+        }
+    }
+}
+
+// Examine one track at the scan cursor; false when no mounted drive
+// has reference hashes to check against.
+bool ScrubThread::scrubOne()
+{
+    QMutexLocker locker(&m_lock);
+
+    for (int tried = 0; tried < m_count; tried++) {
+        const int unit = m_unit;
+        ImageVerifier *verifier = m_verifiers[unit];
+        Drive &drive = m_drives->drive(unit);
+
+        if (!verifier || !verifier->finished() || !drive.isMounted()
+            || m_track >= drive.trackCount()) {
+            m_unit = (m_unit + 1) % m_count;
+            m_track = 0;
+            continue;
+        }
+
+        const int track = m_track++;
+        const QByteArray ref = verifier->trackHash(track);
+
+        // Unreadable during the mount pass; nothing to compare.
+        if (ref.isEmpty())
+            return true;
+
+        quint8 buf[fdc::MaxTrackLen];
+        const int len = drive.trackLen();
+
+        if (!drive.readTrack(track, buf)) {
+            emit mismatch(unit, track, false);
+            return true;
+        }
+
+        const QByteArray now = hashTrack(buf, len);
+        if (now == ref)
+            return true;
+
+        // A track the session wrote is supposed to differ; the new
+        // contents become the reference.  (Scrubbing starts only after
+        // two idle seconds, so the write-behind journal has drained.)
+        if (drive.trackWritten(track)) {
+            verifier->refreshTrackHash(track, now);
+            return true;
+        }
+
+        // Corruption: restore from the master copy where the backend
+        // keeps one, then re-check.
+        bool repaired = false;
+        if (drive.refetchTrack(track)) {
+            m_caches[unit]->invalidate(track);
+            repaired = drive.readTrack(track, buf)
+                       && hashTrack(buf, len) == ref;
+        }
+
+        emit mismatch(unit, track, repaired);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,78 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * scrubthread.h -- idle-time verify-and-scrub of mounted images
+ */
+
+#ifndef SCRUBTHREAD_H
+#define SCRUBTHREAD_H
+
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+
+#include <atomic>
+
+class DriveTable;
+class ImageVerifier;
+class TrackCache;
+struct EngineStatus;
+
+/*
+ * Background thread that hunts for bit rot while the links are quiet:
+ * once the engines have seen no command for IdleThresholdMs (read off
+ * the shared command-arrival clock), it walks the mounted drives a
+ * track at a time, re-reads each track and checks its SHA-1 against
+ * the reference the mount-time verifier recorded.  A track the session
+ * legitimately wrote just has its reference refreshed; a genuine
+ * mismatch is repaired by re-fetching the track from the master copy
+ * where the backend keeps one, and reported either way.
+ *
+ * The idle clock is re-checked before every track, so the scrubber
+ * stands down within one track read of a command arriving -- the hot
+ * path never waits on it.  Drives mounted without verification have no
+ * reference hashes and are skipped.
+ */
+class ScrubThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    static constexpr int PassIntervalMs = 250;
+    static constexpr qint64 IdleThresholdMs = 2000;
+    // Tracks examined per pass while the links stay quiet.
+    static constexpr int TracksPerPass = 8;
+
+    ScrubThread(DriveTable *drives, TrackCache *const *caches, int count,
+                const EngineStatus *status, QObject *parent = nullptr);
+    ~ScrubThread();
+
+    // Hand over (or revoke, with null) the mount-time verifier whose
+    // hashes the scrubber checks against; call on mount and before the
+    // verifier is destroyed.
+    void setVerifier(int unit, ImageVerifier *verifier);
+
+signals:
+    void mismatch(int unit, int track, bool repaired);
+
+protected:
+    void run() override;
+
+private:
+    bool scrubOne();
+
+    DriveTable *m_drives;
+    TrackCache *const *m_caches;
+    int m_count;
+    const EngineStatus *m_status;
+    std::atomic<bool> m_stop { false };
+
+    // Guards the verifier table and the scan cursor; held across a
+    // track check so a verifier cannot be revoked mid-use.
+    QMutex m_lock;
+    QVector<ImageVerifier *> m_verifiers;
+    int m_unit = 0;
+    int m_track = 0;
+};
+
+#endif // SCRUBTHREAD_H
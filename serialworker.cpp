@@ -0,0 +1,656 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * serialworker.cpp -- FDC+ protocol engine, hosted in its own thread
+ */
+
+#include "serialworker.h"
+#include "checksum.h"
+#include "drive.h"
+#include "drivetable.h"
+#include "fdctransport.h"
+#include "flightrecorder.h"
+#include "trackcache.h"
+#include "writejournal.h"
+
+#include <QSettings>
+#include <QThread>
+#include <QTimer>
+
+#include <cstring>
+#include <iterator>
+
+// Rates the FDC+ supports, fastest first; fallback walks right.
+static const int fallbackRates[] = { 460800, 403200, 230400 };
+
+// Hosts the execute stage; all the logic lives in
+// SerialWorker::engineLoop().
+class EngineThread : public QThread
+{
+public:
+    explicit EngineThread(SerialWorker *worker)
+        : m_worker(worker)
+    {
+    }
+
+protected:
+    void run() override { m_worker->engineLoop(); }
+
+private:
+    SerialWorker *m_worker;
+};
+
+SerialWorker::SerialWorker(DriveTable *drives, TrackCache *const *caches,
+                           WriteJournal *journal, LatencyStats *stats,
+                           DriveStats *driveStats, EngineStatus *status,
+                           FlightRecorder *recorder, QObject *parent)
+    : QObject(parent)
+    , m_drives(drives)
+    , m_caches(caches)
+    , m_journal(journal)
+    , m_stats(stats)
+    , m_driveStats(driveStats)
+    , m_status(status)
+    , m_recorder(recorder)
+{
+}
+
+SerialWorker::~SerialWorker()
+{
+    stopEngine();
+}
+
+void SerialWorker::openPort(const QString &name, int baud)
+{
+    stopEngine();
+
+    // Created here so the transport lives on the worker thread.
+    if (m_transport) {
+        m_transport->close();
+        delete m_transport;
+    }
+
+    m_transport = FdcTransport::create(name, baud, this);
+    connect(m_transport, &FdcTransport::readyRead,
+            this, &SerialWorker::portReadyRead);
+
+    QString error;
+    if (!m_transport->open(&error)) {
+        emit portOpened(false, name, error);
+        return;
+    }
+
+    m_rx.clear();
+    m_writPending = false;
+
+    m_endpoint = name;
+    m_baud = baud;
+    m_bytesRx = 0;
+    m_bytesTx = 0;
+    m_crcErrors.store(0);
+
+    if (!m_monitorTimer) {
+        m_monitorTimer = new QTimer(this);
+        connect(m_monitorTimer, &QTimer::timeout,
+                this, &SerialWorker::monitorTick);
+    }
+    m_monitorTimer->start(MonitorIntervalMs);
+
+    startEngine();
+
+    emit portOpened(true, name, QString());
+}
+
+void SerialWorker::closePort()
+{
+    stopEngine();
+
+    if (m_transport)
+        m_transport->close();
+
+    if (m_monitorTimer)
+        m_monitorTimer->stop();
+
+    m_rx.clear();
+    m_writPending = false;
+}
+
+void SerialWorker::startEngine()
+{
+    m_engineStop.store(false);
+    m_engine = new EngineThread(this);
+    m_engineRunning.store(true, std::memory_order_release);
+    m_engine->start();
+}
+
+void SerialWorker::stopEngine()
+{
+    if (!m_engine)
+        return;
+
+    m_engineStop.store(true);
+    m_cmdQueue.wake();
+
+    // The engine may be parked in pushTx() against a full transmit
+    // ring whose only consumer is this thread; keep draining while
+    // waiting so it can observe the stop flag and exit.
+    while (!m_engine->wait(10))
+        drainTx();
+
+    delete m_engine;
+    m_engine = nullptr;
+
+    // Abandon whatever was in flight; a reopened link starts clean.
+    CmdItem cmd;
+    while (m_cmdQueue.pop(cmd)) {
+    }
+    TxItem tx;
+    while (m_txQueue.pop(tx)) {
+    }
+    m_txNotify.store(false);
+
+    // Segments discarded above were never counted as written; square
+    // the counters so quiescedSince() stays honest after a reopen.
+    m_txWritten.store(m_txQueued.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+
+    // With both rings drained nothing here references any drive;
+    // quiescedSince() reports true unconditionally from now on.
+    m_engineRunning.store(false, std::memory_order_release);
+}
+
+void SerialWorker::monitorTick()
+{
+    const int errors = m_crcErrors.exchange(0);
+
+    emit linkStats(m_endpoint,
+                   double(m_bytesRx) * 1000.0 / MonitorIntervalMs,
+                   double(m_bytesTx) * 1000.0 / MonitorIntervalMs,
+                   errors, m_baud);
+
+    m_bytesRx = 0;
+    m_bytesTx = 0;
+
+    if (errors < FallbackErrorThreshold)
+        return;
+
+    if (!QSettings().value(QStringLiteral("autoFallback"), false).toBool())
+        return;
+
+    // Marginal wiring: step down to the next supported rate and reopen.
+    // TCP bridges ignore the baud rate, so only serial links qualify.
+    if (m_endpoint.startsWith(QLatin1String("tcp:")))
+        return;
+
+    for (size_t i = 0; i + 1 < std::size(fallbackRates); i++) {
+        if (fallbackRates[i] == m_baud) {
+            const int slower = fallbackRates[i + 1];
+            closePort();
+            openPort(m_endpoint, slower);
+            break;
+        }
+    }
+}
+
+void SerialWorker::portReadyRead()
+{
+    // Drain the port straight into the ring; no intermediate
+    // QByteArray, no allocation.
+    for (;;) {
+        char *dst;
+        const int space = m_rx.contiguousFree(&dst);
+        if (space == 0) {
+            processBuffer();
+            continue;
+        }
+
+        const qint64 n = m_transport->read(dst, space);
+        if (n <= 0)
+            break;
+
+        m_rx.commitWrite(int(n));
+        m_bytesRx += quint64(n);
+
+        if (n < space)
+            break;
+    }
+
+    processBuffer();
+}
+
+// Receive stage: frame what the ring holds into command descriptors.
+// No drive or cache work happens here; that is the engine's job.
+void SerialWorker::processBuffer()
+{
+    for (;;) {
+        if (m_writPending) {
+            if (m_rx.size() < m_writLen + 2)
+                return;
+
+            CmdItem item;
+            item.type = CmdItem::WritData;
+            item.param1 = m_writParam1;
+            item.param2 = quint16(m_writLen);
+
+            // Capture the payload into a pooled buffer; the checksum
+            // rides separately so downstream holders see exactly one
+            // track.
+            if (QByteArray *slot = m_pool.acquire(m_writLen)) {
+                m_rx.peek(reinterpret_cast<quint8 *>(slot->data()), 0,
+                          m_writLen);
+                item.payload = *slot;
+                m_pool.publish(slot);
+            } else {
+                item.payload.resize(m_writLen);
+                m_rx.peek(reinterpret_cast<quint8 *>(item.payload.data()), 0,
+                          m_writLen);
+            }
+
+            quint8 crc[2];
+            m_rx.peek(crc, m_writLen, 2);
+            item.crc = fdc::getWord(crc);
+
+            m_rx.consume(m_writLen + 2);
+            m_writPending = false;
+            pushCmd(std::move(item));
+            continue;
+        }
+
+        if (m_rx.size() < fdc::CmdLen)
+            return;
+
+        quint8 block[fdc::CmdLen];
+        m_rx.peek(block, 0, fdc::CmdLen);
+
+        if (fdc::checksum(block, 8) != fdc::getWord(block + 8)) {
+            // Bad command checksum; resynchronize one byte at a time,
+            // counting the error once per corrupted stretch.
+            if (!m_inResync) {
+                m_inResync = true;
+                m_crcErrors.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_rx.consume(1);
+            continue;
+        }
+        m_inResync = false;
+
+        CmdItem item;
+        item.param1 = fdc::getWord(block + 4);
+        item.param2 = fdc::getWord(block + 6);
+
+        if (memcmp(block, "STAT", 4) == 0) {
+            item.type = CmdItem::Stat;
+        } else if (memcmp(block, "READ", 4) == 0) {
+            item.type = CmdItem::Read;
+        } else if (memcmp(block, "WRIT", 4) == 0) {
+            item.type = CmdItem::Writ;
+            // Mirror the engine's acceptance test: the FDC+ only sends
+            // the data phase after a positive acknowledge.
+            if (writAcceptable(item.param1, item.param2)) {
+                m_writPending = true;
+                m_writParam1 = item.param1;
+                m_writLen = item.param2;
+            }
+        }
+
+        m_rx.consume(fdc::CmdLen);
+
+        if (item.type != CmdItem::None)
+            pushCmd(std::move(item));
+    }
+}
+
+void SerialWorker::pushCmd(CmdItem &&item)
+{
+    // Backpressure: if the engine is behind, keep the transmitter
+    // moving while waiting for a slot (the engine may itself be
+    // waiting on transmit space).  With the engine stopping nothing
+    // drains the ring; drop the command, the link is going down.
+    while (!m_cmdQueue.push(std::move(item))) {
+        if (m_engineStop.load(std::memory_order_acquire))
+            return;
+        drainTx();
+    }
+}
+
+bool SerialWorker::writAcceptable(quint16 param1, quint16 param2) const
+{
+    const int unit = fdc::driveOf(param1);
+    const int track = fdc::trackOf(param1);
+
+    if (unit >= fdc::DriveCount)
+        return false;
+
+    Drive &drive = m_drives->drive(unit);
+
+    return drive.isMounted() && track < drive.trackCount()
+           && param2 == drive.trackLen();
+}
+
+// Receive stage: hand finished response segments to the transport, in
+// the order the engine queued them.
+void SerialWorker::drainTx()
+{
+    m_txNotify.store(false, std::memory_order_release);
+
+    TxItem item;
+    while (m_txQueue.pop(item)) {
+        if (m_transport) {
+            if (item.smallLen > 0) {
+                m_transport->write(
+                    reinterpret_cast<const char *>(item.small),
+                    item.smallLen);
+                m_bytesTx += quint64(item.smallLen);
+            }
+
+            if (item.ptr && item.len > 0) {
+                m_transport->write(reinterpret_cast<const char *>(item.ptr),
+                                   item.len);
+                m_bytesTx += quint64(item.len);
+            }
+
+            if (item.end)
+                m_transport->endResponse();
+        }
+
+        // Drop the pointer and owner before declaring the segment
+        // written; quiescedSince() may free the storage right after.
+        item = TxItem();
+        m_txWritten.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void SerialWorker::engineLoop()
+{
+    CmdItem item;
+
+    while (!m_engineStop.load(std::memory_order_acquire)) {
+        if (!m_cmdQueue.popWait(item))
+            continue;
+
+        m_cmdStarted.fetch_add(1, std::memory_order_relaxed);
+        m_status->noteCommand();
+
+        switch (item.type) {
+        case CmdItem::Stat:
+            m_cmdTimer.start();
+            m_firstByteNs = -1;
+            m_recorder->note(FlightRecorder::CmdStat, item.param1,
+                             item.param2);
+            execStat(item.param1);
+            m_stats->record(LatencyStats::Stat, m_firstByteNs,
+                            m_cmdTimer.nsecsElapsed());
+            break;
+
+        case CmdItem::Read:
+            m_cmdTimer.start();
+            m_firstByteNs = -1;
+            m_recorder->note(FlightRecorder::CmdRead, item.param1,
+                             item.param2);
+            execRead(item.param1, item.param2);
+            m_stats->record(LatencyStats::Read, m_firstByteNs,
+                            m_cmdTimer.nsecsElapsed());
+            break;
+
+        case CmdItem::Writ:
+            // Recorded when the data phase completes.
+            m_cmdTimer.start();
+            m_firstByteNs = -1;
+            m_recorder->note(FlightRecorder::CmdWrit, item.param1,
+                             item.param2);
+            execWrit(item.param1, item.param2);
+            break;
+
+        case CmdItem::WritData:
+            m_recorder->note(FlightRecorder::CmdWritData, item.param1,
+                             item.param2);
+            execWritData(item);
+            m_stats->record(LatencyStats::Writ, m_firstByteNs,
+                            m_cmdTimer.nsecsElapsed());
+            break;
+
+        default:
+            break;
+        }
+
+        item = CmdItem();  // release any payload reference promptly
+        m_cmdDone.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void SerialWorker::execStat(quint16 param1)
+{
+    Q_UNUSED(param1);
+
+    quint16 mounted = 0;
+    for (int i = 0; i < fdc::DriveCount; i++) {
+        if (m_drives->drive(i).isMounted())
+            mounted |= 1 << i;
+    }
+
+    pushBlock("OK  ", mounted, 0, true);
+}
+
+void SerialWorker::execRead(quint16 param1, quint16 param2)
+{
+    const int unit = fdc::driveOf(param1);
+    const int track = fdc::trackOf(param1);
+
+    if (unit >= fdc::DriveCount) {
+        pushBlock("NOT ", param1, 0, true);
+        return;
+    }
+
+    // Loaded once; the whole command is served from this drive even if
+    // a swap lands meanwhile.
+    Drive &drive = m_drives->drive(unit);
+
+    if (!drive.isMounted() || track >= drive.trackCount()
+        || param2 != drive.trackLen()) {
+        m_driveStats[unit].countRetry();
+        pushBlock("NOT ", param1, 0, true);
+        return;
+    }
+
+    // The virtual head is over this track now; cache eviction keeps
+    // its neighborhood resident.
+    m_caches[unit]->noteHeadPosition(track);
+
+    // Zero-copy path: mapped, shared and pinned images hand back a
+    // stable pointer into their backing buffer.
+    const quint8 *payload = drive.constTrack(track);
+
+    // Otherwise serve out of the read-ahead cache; the QByteArray
+    // rides along in the transmit descriptors and keeps the bytes
+    // alive until the receive stage has written them out.
+    QByteArray data;
+    if (!payload) {
+        // A hot swap can re-point the cache at the new image between
+        // our drive load and this fill; a track of the wrong geometry
+        // must not be transmitted, or the segment walk below runs past
+        // the end of the buffer.
+        if (!m_caches[unit]->getTrack(track, data)
+            || data.size() != param2) {
+            m_driveStats[unit].countRetry();
+            pushBlock("NOT ", param1, 0, true);
+            return;
+        }
+        payload = reinterpret_cast<const quint8 *>(data.constData());
+    }
+
+    sendTrack(drive, param1, payload, param2, data);
+    m_driveStats[unit].countRead(quint64(param2));
+    m_status->noteServed(unit, track);
+}
+
+// Queue a track as header, payload and trailing checksum segments
+// straight from their source buffers; no response assembly buffer.
+void SerialWorker::sendTrack(Drive &drive, quint16 param1,
+                             const quint8 *payload, int len, QByteArray owner)
+{
+    quint8 crc[2];
+
+    pushBlock("OK  ", param1, quint16(len), false);
+
+    // With an interleave configured, emit sectors in the precomputed
+    // physical order; the additive checksum is accumulated per sector
+    // with the compile-time sector length, which sums to the checksum
+    // of the bytes as transmitted.
+    const std::vector<int> &order = drive.interleaveOrder();
+    if (!order.empty()) {
+        quint16 sum = 0;
+        for (int logical : order) {
+            const quint8 *sector = payload
+                + qsizetype(logical) * fdc::SectorLen;
+
+            TxItem item;
+            item.ptr = sector;
+            item.len = fdc::SectorLen;
+            item.owner = owner;
+            pushTx(std::move(item));
+
+            sum += fdc::checksumFixed<fdc::SectorLen>(sector);
+        }
+        fdc::putWord(crc, sum);
+    } else {
+        TxItem item;
+        item.ptr = payload;
+        item.len = len;
+        item.owner = std::move(owner);
+        pushTx(std::move(item));
+
+        // Geometry-specialized for known track lengths, generic
+        // otherwise.
+        fdc::putWord(crc, drive.trackChecksum(payload));
+    }
+
+    TxItem tail;
+    memcpy(tail.small, crc, 2);
+    tail.smallLen = 2;
+    tail.end = true;
+    pushTx(std::move(tail));
+}
+
+void SerialWorker::execWrit(quint16 param1, quint16 param2)
+{
+    if (!writAcceptable(param1, param2)) {
+        if (fdc::driveOf(param1) < fdc::DriveCount)
+            m_driveStats[fdc::driveOf(param1)].countRetry();
+        pushBlock("NOT ", param1, 0, true);
+        return;
+    }
+
+    m_caches[fdc::driveOf(param1)]->noteHeadPosition(fdc::trackOf(param1));
+
+    pushBlock("OK  ", param1, param2, true);
+}
+
+void SerialWorker::execWritData(const CmdItem &item)
+{
+    const int unit = fdc::driveOf(item.param1);
+    const int track = fdc::trackOf(item.param1);
+    Drive &drive = m_drives->drive(unit);
+    const quint8 *data =
+        reinterpret_cast<const quint8 *>(item.payload.constData());
+
+    // A hot swap between acceptance and data phase can land the data
+    // on a drive of a different geometry; refuse rather than write a
+    // short (or over-read a long) track.
+    if (!drive.isMounted() || item.param2 != drive.trackLen()
+        || track >= drive.trackCount()) {
+        m_driveStats[unit].countRetry();
+        pushBlock("NOT ", item.param1, 0, true);
+        return;
+    }
+
+    // Specialized full-track checksum for the geometry selected at
+    // mount; odd lengths take the runtime-length kernel inside.
+    const quint16 sum = drive.trackChecksum(data);
+
+    if (sum != item.crc) {
+        m_crcErrors.fetch_add(1, std::memory_order_relaxed);
+        m_driveStats[unit].countCrcFailure();
+        m_driveStats[unit].countRetry();
+        pushBlock("NOT ", item.param1, 0, true);
+        return;
+    }
+
+    if (drive.writeBehind()) {
+        // Make the cache serve the new contents and acknowledge
+        // without waiting on storage; the journal thread commits in
+        // coalesced batches.  Both take shallow copies of the pooled
+        // capture buffer.
+        m_journal->append(&drive, track, item.payload);
+        // Only feed the cache while this unit still maps to the drive
+        // we wrote; after a swap the cache belongs to the new image.
+        if (&drive == &m_drives->drive(unit))
+            m_caches[unit]->put(track, item.payload);
+        m_driveStats[unit].countWrite(quint64(item.param2));
+        m_status->noteServed(unit, track);
+        pushBlock("OK  ", item.param1, 0, true);
+        return;
+    }
+
+    if (!drive.writeTrack(track, data)) {
+        m_driveStats[unit].countRetry();
+        pushBlock("NOT ", item.param1, 0, true);
+        return;
+    }
+
+    if (&drive == &m_drives->drive(unit))
+        m_caches[unit]->invalidate(track);
+    m_driveStats[unit].countWrite(quint64(item.param2));
+    m_status->noteServed(unit, track);
+    pushBlock("OK  ", item.param1, 0, true);
+}
+
+void SerialWorker::pushBlock(const char *cmd, quint16 param1, quint16 param2,
+                             bool end)
+{
+    TxItem item;
+
+    memcpy(item.small, cmd, 4);
+    fdc::putWord(item.small + 4, param1);
+    fdc::putWord(item.small + 6, param2);
+    fdc::putWord(item.small + 8, fdc::checksum(item.small, 8));
+    item.smallLen = fdc::CmdLen;
+    item.end = end;
+
+    m_recorder->note(cmd[0] == 'O' ? FlightRecorder::RespOk
+                                   : FlightRecorder::RespNot,
+                     param1, param2);
+    markFirstByte();
+    pushTx(std::move(item));
+}
+
+void SerialWorker::pushTx(TxItem &&item)
+{
+    for (;;) {
+        // Shutdown: the worker is waiting for this thread inside
+        // stopEngine(), so a full ring would never drain; drop the
+        // segment and let the loop wind down.
+        if (m_engineStop.load(std::memory_order_acquire))
+            return;
+
+        const bool pushed = m_txQueue.push(std::move(item));
+        if (pushed)
+            m_txQueued.fetch_add(1, std::memory_order_relaxed);
+
+        // Edge-triggered kick for the worker's event loop; coalesced
+        // while it is already scheduled to drain.
+        if (!m_txNotify.exchange(true, std::memory_order_acq_rel))
+            QMetaObject::invokeMethod(this, &SerialWorker::drainTx,
+                                      Qt::QueuedConnection);
+
+        if (pushed)
+            return;
+
+        QThread::yieldCurrentThread();
+    }
+}
+
+void SerialWorker::markFirstByte()
+{
+    if (m_firstByteNs < 0)
+        m_firstByteNs = m_cmdTimer.nsecsElapsed();
+}
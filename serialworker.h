@@ -0,0 +1,227 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * serialworker.h -- FDC+ protocol engine, hosted in its own thread
+ */
+
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <atomic>
+
+#include "bufferpool.h"
+#include "drivestats.h"
+#include "enginestatus.h"
+#include "fdcproto.h"
+#include "latencystats.h"
+#include "ringbuffer.h"
+#include "spscqueue.h"
+
+class Drive;
+class DriveTable;
+class FdcTransport;
+class FlightRecorder;
+class QThread;
+class QTimer;
+class TrackCache;
+class WriteJournal;
+
+/*
+ * Owns its transport (serial port or TCP bridge) and runs the full
+ * FDC+ protocol as a two-stage pipeline:
+ *
+ *   receive stage   the worker thread: drains the port into the ring,
+ *                   frames and checksums command blocks, and forwards
+ *                   fixed-size descriptors; it also writes finished
+ *                   response segments back to the transport.
+ *
+ *   execute stage   a dedicated engine thread: pops descriptors,
+ *                   performs the drive and cache work, and queues the
+ *                   response segments (zero-copy where the backend
+ *                   allows) for transmission.
+ *
+ * The stages meet at two lock-free SPSC rings, so a command can be
+ * framed while its predecessor is still reading the image, and the
+ * steady state crosses no locks and makes no syscalls -- a wakeup is
+ * paid only on an idle edge.
+ *
+ * The GUI talks to the worker only through queued slot invocations and
+ * hears back only through queued signals.  Drive and TrackCache objects
+ * are owned by the main window and shared by pointer; both are
+ * internally synchronized.
+ */
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    SerialWorker(DriveTable *drives, TrackCache *const *caches,
+                 WriteJournal *journal, LatencyStats *stats,
+                 DriveStats *driveStats, EngineStatus *status,
+                 FlightRecorder *recorder, QObject *parent = nullptr);
+    ~SerialWorker();
+
+    // Hot-swap retirement support.  A drive retired from the slot table
+    // may still be referenced by the command executing at the moment of
+    // the swap and by transmit segments pointing into its storage.
+    // commandMark() snapshots how many commands have begun;
+    // quiescedSince() reports whether every one of them has completed
+    // and the transmit ring has drained -- past that point this worker
+    // holds no pointer into a drive retired before the mark.  Both read
+    // only atomics and are safe from any thread.
+    quint64 commandMark() const
+    {
+        return m_cmdStarted.load(std::memory_order_acquire);
+    }
+
+    bool quiescedSince(quint64 mark) const
+    {
+        // A stopped engine drained both rings on the way out.
+        if (!m_engineRunning.load(std::memory_order_acquire))
+            return true;
+
+        if (m_cmdDone.load(std::memory_order_acquire) < mark)
+            return false;
+
+        // The ring reading empty is not enough: drainTx() holds a
+        // popped segment across the transport write, so compare
+        // segments written out against segments queued.  Queued is
+        // read first; anything counted by then (which covers every
+        // pre-mark segment, published by the command-done increment
+        // above) must have been written.
+        const quint64 queued = m_txQueued.load(std::memory_order_acquire);
+        return m_txWritten.load(std::memory_order_acquire) >= queued;
+    }
+
+public slots:
+    void openPort(const QString &name, int baud);
+    void closePort();
+
+signals:
+    void portOpened(bool ok, const QString &name, const QString &error);
+    // Emitted once per monitor interval with effective goodput and the
+    // checksum-error count seen in that interval.
+    void linkStats(const QString &name, double rxBps, double txBps,
+                   int crcErrors, int baud);
+
+private slots:
+    void portReadyRead();
+    void monitorTick();
+    void drainTx();
+
+private:
+    friend class EngineThread;
+
+    // Command descriptor, receive stage -> engine.
+    struct CmdItem {
+        enum Type { None, Stat, Read, Writ, WritData };
+        Type type = None;
+        quint16 param1 = 0;
+        quint16 param2 = 0;
+        quint16 crc = 0;        // WritData: checksum as received
+        QByteArray payload;     // WritData: exactly one track of bytes
+    };
+
+    // Response segment, engine -> receive stage.  Either a short block
+    // held inline or a pointer into a buffer that owner (or the image
+    // mapping itself) keeps alive until transmitted.
+    struct TxItem {
+        quint8 small[fdc::CmdLen];
+        int smallLen = 0;
+        const quint8 *ptr = nullptr;
+        int len = 0;
+        QByteArray owner;
+        bool end = false;       // response complete; release the batch
+    };
+
+    // Receive stage.
+    void processBuffer();
+    void pushCmd(CmdItem &&item);
+    bool writAcceptable(quint16 param1, quint16 param2) const;
+    void startEngine();
+    void stopEngine();
+
+    // Execute stage (engine thread only).
+    void engineLoop();
+    void execStat(quint16 param1);
+    void execRead(quint16 param1, quint16 param2);
+    void execWrit(quint16 param1, quint16 param2);
+    void execWritData(const CmdItem &item);
+    void pushTx(TxItem &&item);
+    void pushBlock(const char *cmd, quint16 param1, quint16 param2, bool end);
+    void sendTrack(Drive &drive, quint16 param1, const quint8 *payload,
+                   int len, QByteArray owner);
+    void markFirstByte();
+
+    // Atomic slot table: the drive for a unit is loaded once per
+    // command, so a hot swap lands between commands.
+    DriveTable *m_drives;
+    TrackCache *const *m_caches;
+    WriteJournal *m_journal;
+    LatencyStats *m_stats;
+    DriveStats *m_driveStats;           // one ledger per drive, shared
+    EngineStatus *m_status;             // GUI samples this, no signals
+    FlightRecorder *m_recorder;         // shared trace ring, lock-free
+
+    // Engine side: runs from descriptor pickup; WRIT keeps it running
+    // across the data phase so the recorded latency covers the whole
+    // transaction.  First-byte time is when the leading response
+    // segment is handed to the transmit ring.
+    QElapsedTimer m_cmdTimer;
+    qint64 m_firstByteNs = -1;
+
+    // Link monitor state, reset each interval.  A marginal serial link
+    // shows up as checksum errors; with automatic fallback enabled the
+    // worker steps the baud rate down and reopens.
+    static constexpr int MonitorIntervalMs = 5000;
+    static constexpr int FallbackErrorThreshold = 3;
+    QTimer *m_monitorTimer = nullptr;
+    QString m_endpoint;
+    int m_baud = 0;
+    quint64 m_bytesRx = 0;
+    quint64 m_bytesTx = 0;
+    std::atomic<int> m_crcErrors { 0 };
+    bool m_inResync = false;
+
+    FdcTransport *m_transport = nullptr;
+
+    // Fixed receive ring: the port is drained straight into it and
+    // commands are framed in place, no allocations in steady state.
+    RingBuffer m_rx { 2 * (fdc::MaxTrackLen + 2) };
+
+    // Recycled WRIT capture buffers; sized for a full journal plus a
+    // cacheful of write-behind tracks still holding references.
+    BufferPool m_pool { 48, fdc::MaxTrackLen + 2 };
+
+    // Pipeline rings and the engine thread that consumes commands.
+    SpscQueue<CmdItem, 64> m_cmdQueue;
+    SpscQueue<TxItem, 256> m_txQueue;
+    QThread *m_engine = nullptr;
+    std::atomic<bool> m_engineStop { false };
+    std::atomic<bool> m_txNotify { false };
+
+    // Command boundary counters for quiescedSince(): started at
+    // descriptor pickup, done once the response is fully queued.
+    std::atomic<bool> m_engineRunning { false };
+    std::atomic<quint64> m_cmdStarted { 0 };
+    std::atomic<quint64> m_cmdDone { 0 };
+
+    // Transmit segment counters: queued bumps on a successful pushTx,
+    // written only after the transport write returns, so a segment
+    // popped from the ring but still being written keeps the two
+    // apart and blocks retirement.
+    std::atomic<quint64> m_txQueued { 0 };
+    std::atomic<quint64> m_txWritten { 0 };
+
+    // WRIT arrives in two pieces: the command block, then (after the
+    // engine's first acknowledge) the track data and its checksum.
+    bool m_writPending = false;
+    quint16 m_writParam1 = 0;
+    int m_writLen = 0;
+};
+
+#endif // SERIALWORKER_H
@@ -0,0 +1,132 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * settingsdialog.cpp -- serial link configuration
+ */
+
+#include "settingsdialog.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSerialPortInfo>
+#include <QSettings>
+#include <QVBoxLayout>
+
+static const int baudRates[] = { 230400, 403200, 460800 };
+
+SettingsDialog::SettingsDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    QSettings settings;
+    const QStringList enabled =
+        settings.value(QStringLiteral("ports")).toStringList();
+
+    auto *layout = new QVBoxLayout(this);
+
+    layout->addWidget(new QLabel(tr("Serve FDC+ links on:")));
+
+    m_portList = new QListWidget;
+    const auto ports = QSerialPortInfo::availablePorts();
+    for (const QSerialPortInfo &info : ports) {
+        auto *item = new QListWidgetItem(info.portName(), m_portList);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(enabled.contains(info.portName())
+                                ? Qt::Checked : Qt::Unchecked);
+    }
+    // Previously saved TCP bridge endpoints are not discoverable;
+    // re-list whatever was enabled.
+    for (const QString &endpoint : enabled) {
+        if (!endpoint.startsWith(QLatin1String("tcp:")))
+            continue;
+        auto *item = new QListWidgetItem(endpoint, m_portList);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Checked);
+    }
+    layout->addWidget(m_portList);
+
+    auto *tcpLayout = new QHBoxLayout;
+    m_tcpEdit = new QLineEdit;
+    m_tcpEdit->setPlaceholderText(tr("tcp:host:port"));
+    tcpLayout->addWidget(m_tcpEdit);
+    auto *addButton = new QPushButton(tr("Add Bridge"));
+    connect(addButton, &QPushButton::clicked,
+            this, &SettingsDialog::addTcpEndpoint);
+    tcpLayout->addWidget(addButton);
+    layout->addLayout(tcpLayout);
+
+    auto *baudLayout = new QHBoxLayout;
+    baudLayout->addWidget(new QLabel(tr("Baud:")));
+    m_baudBox = new QComboBox;
+    for (int rate : baudRates)
+        m_baudBox->addItem(QString::number(rate));
+    m_baudBox->setCurrentText(
+        settings.value(QStringLiteral("baud"), 403200).toString());
+    baudLayout->addWidget(m_baudBox);
+    baudLayout->addStretch();
+    layout->addLayout(baudLayout);
+
+    m_fallbackCheck = new QCheckBox(tr("Fall back to a slower baud rate "
+                                       "on repeated checksum errors"));
+    m_fallbackCheck->setChecked(
+        settings.value(QStringLiteral("autoFallback"), false).toBool());
+    layout->addWidget(m_fallbackCheck);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok
+                                         | QDialogButtonBox::Cancel);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    setWindowTitle(tr("Serial Links"));
+}
+
+void SettingsDialog::addTcpEndpoint()
+{
+    QString endpoint = m_tcpEdit->text().trimmed();
+    if (endpoint.isEmpty())
+        return;
+
+    if (!endpoint.startsWith(QLatin1String("tcp:")))
+        endpoint.prepend(QLatin1String("tcp:"));
+
+    auto *item = new QListWidgetItem(endpoint, m_portList);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(Qt::Checked);
+
+    m_tcpEdit->clear();
+}
+
+QStringList SettingsDialog::selectedPorts() const
+{
+    QStringList ports;
+
+    for (int i = 0; i < m_portList->count(); i++) {
+        const QListWidgetItem *item = m_portList->item(i);
+        if (item->checkState() == Qt::Checked)
+            ports.append(item->text());
+    }
+
+    return ports;
+}
+
+int SettingsDialog::baudRate() const
+{
+    return m_baudBox->currentText().toInt();
+}
+
+void SettingsDialog::accept()
+{
+    QSettings settings;
+    settings.setValue(QStringLiteral("ports"), selectedPorts());
+    settings.setValue(QStringLiteral("baud"), baudRate());
+    settings.setValue(QStringLiteral("autoFallback"),
+                      m_fallbackCheck->isChecked());
+
+    QDialog::accept();
+}
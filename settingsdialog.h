@@ -0,0 +1,48 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * settingsdialog.h -- serial link configuration
+ */
+
+#ifndef SETTINGSDIALOG_H
+#define SETTINGSDIALOG_H
+
+#include <QDialog>
+
+class QCheckBox;
+class QComboBox;
+class QLineEdit;
+class QListWidget;
+
+/*
+ * Lets the operator pick which endpoints serve FDC+ links and the baud
+ * rate serial ones run at.  Local serial ports are listed
+ * automatically; "tcp:host:port" endpoints for serial-over-TCP bridges
+ * can be added by hand.  One worker thread is spun up per checked
+ * endpoint; all links share the same drives and caches.  Selections
+ * are persisted in QSettings ("ports" and "baud").
+ */
+class SettingsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SettingsDialog(QWidget *parent = nullptr);
+
+    QStringList selectedPorts() const;
+    int baudRate() const;
+
+public slots:
+    void accept() override;
+
+private slots:
+    void addTcpEndpoint();
+
+private:
+    QListWidget *m_portList;
+    QComboBox *m_baudBox;
+    QLineEdit *m_tcpEdit;
+    QCheckBox *m_fallbackCheck;
+};
+
+#endif // SETTINGSDIALOG_H
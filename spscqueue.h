@@ -0,0 +1,124 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * spscqueue.h -- lock-free single-producer single-consumer ring queue
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QSemaphore>
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+/*
+ * Fixed-capacity ring of descriptors between exactly one producer
+ * thread and one consumer thread.  Steady-state traffic takes no locks
+ * and makes no syscalls: push and pop are an indexed store/load plus
+ * one release/acquire on the ring indices.
+ *
+ * The semaphore exists only for the idle edge.  A consumer that finds
+ * the ring empty spins briefly, advertises that it is going to sleep,
+ * re-checks, and only then blocks; the producer pays for a wakeup only
+ * when it catches that advertisement.  While work keeps flowing
+ * neither side ever touches it.
+ *
+ * Capacity must be a power of two.  One slot is sacrificed to tell
+ * full from empty.
+ */
+template <typename T, int Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    bool push(T &&item)
+    {
+        const int tail = m_tail.load(std::memory_order_relaxed);
+        const int next = (tail + 1) & (Capacity - 1);
+
+        if (next == m_head.load(std::memory_order_acquire))
+            return false;  // full
+
+        m_slots[tail] = std::move(item);
+        m_tail.store(next, std::memory_order_release);
+
+        // seq_cst pairs with the fence in popWait(): either this
+        // exchange sees the consumer's advertisement, or the
+        // consumer's recheck sees the tail stored above.
+        if (m_sleeping.exchange(false, std::memory_order_seq_cst))
+            m_idle.release();
+
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        const int head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;  // empty
+
+        item = std::move(m_slots[head]);
+        m_slots[head] = T();
+        m_head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+
+        return true;
+    }
+
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire)
+               == m_tail.load(std::memory_order_acquire);
+    }
+
+    // Blocking pop for the consumer thread: spin while the pipeline is
+    // hot, sleep on the semaphore once it runs dry.  Returns false
+    // when woken with nothing queued (shutdown).
+    bool popWait(T &item)
+    {
+        for (int spin = 0; spin < 4096; spin++) {
+            if (pop(item))
+                return true;
+        }
+
+        m_sleeping.store(true, std::memory_order_release);
+
+        // Re-check after advertising, or a push that raced us could be
+        // missed forever.  The fence orders the advertisement before
+        // the recheck's tail load: without it the store can sit in the
+        // store buffer while pop() reads a stale tail, and a push
+        // landing in that window sees m_sleeping still false, skips
+        // the wakeup, and we sleep with an item queued.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (pop(item)) {
+            m_sleeping.store(false, std::memory_order_release);
+            return true;
+        }
+
+        m_idle.acquire();
+
+        return pop(item);
+    }
+
+    // Unconditional wakeup, e.g. to let a stopping consumer observe a
+    // shutdown flag.  A surplus permit only causes a spurious loop.
+    void wake()
+    {
+        m_sleeping.store(false, std::memory_order_release);
+        m_idle.release();
+    }
+
+private:
+    std::array<T, Capacity> m_slots;
+    std::atomic<int> m_head { 0 };
+    std::atomic<int> m_tail { 0 };
+    std::atomic<bool> m_sleeping { false };
+    QSemaphore m_idle;
+};
+
+#endif // SPSCQUEUE_H
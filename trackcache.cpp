@@ -0,0 +1,183 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * trackcache.cpp -- per-drive track read-ahead cache
+ */
+
+#include "trackcache.h"
+#include "drive.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+TrackCache::TrackCache(Drive *drive)
+    : m_drive(drive)
+{
+}
+
+bool TrackCache::getTrack(int track, QByteArray &data)
+{
+    {
+        QMutexLocker locker(&m_lock);
+
+        auto it = m_tracks.constFind(track);
+        if (it != m_tracks.constEnd()) {
+            data = it.value();
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            schedulePrefetch(track + 1);
+            return true;
+        }
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+
+    const quint64 epoch = m_epoch.load(std::memory_order_acquire);
+
+    if (!fillTrack(track, data))
+        return false;
+
+    {
+        QMutexLocker locker(&m_lock);
+        // The data is still good for this caller, but if the drive was
+        // swapped (or the cache cleared) while the fill ran it belongs
+        // to the old image -- don't let it repopulate the fresh cache.
+        if (m_epoch.load(std::memory_order_acquire) == epoch)
+            insertLocked(track, data);
+    }
+
+    schedulePrefetch(track + 1);
+
+    return true;
+}
+
+// Read a track into a pooled buffer (falling back to a fresh
+// allocation when the pool is exhausted) and leave a shallow copy in
+// data.
+bool TrackCache::fillTrack(int track, QByteArray &data)
+{
+    Drive *drive = m_drive.load(std::memory_order_acquire);
+    const int len = drive->trackLen();
+
+    QByteArray *slot;
+    {
+        QMutexLocker locker(&m_lock);
+        slot = m_pool.acquire(len);
+    }
+
+    if (!slot) {
+        data.resize(len);
+        return drive->readTrack(track,
+                                reinterpret_cast<quint8 *>(data.data()));
+    }
+
+    const bool ok =
+        drive->readTrack(track, reinterpret_cast<quint8 *>(slot->data()));
+
+    QMutexLocker locker(&m_lock);
+    if (ok)
+        data = *slot;
+    m_pool.publish(slot);
+
+    return ok;
+}
+
+void TrackCache::invalidate(int track)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_tracks.remove(track))
+        m_order.removeOne(track);
+}
+
+void TrackCache::put(int track, const QByteArray &data)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_tracks.contains(track)) {
+        m_tracks[track] = data;
+        return;
+    }
+
+    insertLocked(track, data);
+}
+
+void TrackCache::clear()
+{
+    QMutexLocker locker(&m_lock);
+
+    m_epoch.fetch_add(1, std::memory_order_release);
+    m_tracks.clear();
+    m_order.clear();
+}
+
+void TrackCache::schedulePrefetch(int firstTrack)
+{
+    if (firstTrack >= m_drive.load(std::memory_order_acquire)->trackCount())
+        return;
+
+    // One prefetch in flight at a time is plenty; READs arrive far
+    // slower than the worker can fill four tracks.
+    bool expected = false;
+    if (!m_prefetching.compare_exchange_strong(expected, true))
+        return;
+
+    (void)QtConcurrent::run([this, firstTrack] { prefetch(firstTrack); });
+}
+
+void TrackCache::prefetch(int firstTrack)
+{
+    const quint64 epoch = m_epoch.load(std::memory_order_acquire);
+    const int last = qMin(firstTrack + ReadAhead - 1,
+                          m_drive.load(std::memory_order_acquire)->trackCount()
+                              - 1);
+
+    for (int track = firstTrack; track <= last; track++) {
+        {
+            QMutexLocker locker(&m_lock);
+            if (m_tracks.contains(track))
+                continue;
+        }
+
+        QByteArray data;
+        if (!fillTrack(track, data))
+            break;
+
+        QMutexLocker locker(&m_lock);
+        // Drop the whole burst if the drive was swapped underneath us;
+        // the tracks read belong to the old image.
+        if (m_epoch.load(std::memory_order_acquire) != epoch)
+            break;
+        insertLocked(track, data);
+    }
+
+    m_prefetching.store(false);
+}
+
+void TrackCache::insertLocked(int track, const QByteArray &data)
+{
+    if (m_tracks.contains(track))
+        return;
+
+    while (m_order.size() >= Capacity) {
+        const int head = m_head.load(std::memory_order_relaxed);
+
+        // Evict the resident track farthest from the virtual head;
+        // ties and an unknown head fall back to oldest-first.
+        int victim = 0;
+        if (head >= 0) {
+            int worst = -1;
+            for (int i = 0; i < m_order.size(); i++) {
+                const int dist = qAbs(m_order.at(i) - head);
+                if (dist > worst) {
+                    worst = dist;
+                    victim = i;
+                }
+            }
+        }
+
+        m_tracks.remove(m_order.at(victim));
+        m_order.removeAt(victim);
+    }
+
+    m_tracks.insert(track, data);
+    m_order.append(track);
+}
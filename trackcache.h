@@ -0,0 +1,116 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * trackcache.h -- per-drive track read-ahead cache
+ */
+
+#ifndef TRACKCACHE_H
+#define TRACKCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+#include <atomic>
+
+#include "bufferpool.h"
+#include "fdcproto.h"
+
+class Drive;
+
+/*
+ * Read-ahead cache sitting between the protocol handler and a Drive.
+ *
+ * Every serviced READ kicks off an asynchronous prefetch of the next
+ * ReadAhead tracks, so a sequential workload (the common case for CP/M
+ * boots and build jobs) is served entirely from RAM after the first
+ * request.  Capacity is bounded.
+ *
+ * Eviction follows a virtual head position model: the protocol engine
+ * reports the track each READ/WRIT addresses, and the resident track
+ * farthest from the head goes first -- the current track and its
+ * neighbors stay hot because the next request statistically lands
+ * there, while tracks a long seek away are the cheapest to refetch
+ * relative to their chance of being needed.  With no head position yet
+ * the cache degrades to oldest-first.
+ */
+class TrackCache
+{
+public:
+    // Tracks prefetched beyond the one just read.
+    static constexpr int ReadAhead = 4;
+
+    // Upper bound on resident tracks per drive.
+    static constexpr int Capacity = 16;
+
+    explicit TrackCache(Drive *drive);
+
+    // Re-point the cache after a hot swap; the caller clears stale
+    // entries with clear().  The drive is published before the epoch
+    // bump, so a fill that observes the new epoch also observed the new
+    // drive; fills begun under an older epoch are handed to their
+    // caller but never inserted, so a slow read of the old image cannot
+    // repopulate the cache after clear().
+    void setDrive(Drive *drive)
+    {
+        m_drive.store(drive, std::memory_order_release);
+        m_epoch.fetch_add(1, std::memory_order_release);
+    }
+
+    // Fetch a track, from cache if resident, and schedule read-ahead of
+    // the tracks that follow it.
+    bool getTrack(int track, QByteArray &data);
+
+    // A WRIT landed on this track; drop any stale cached copy.
+    void invalidate(int track);
+
+    // Install fresh track contents, e.g. a write-behind WRIT that has
+    // not reached the image yet.
+    void put(int track, const QByteArray &data);
+
+    // Drop everything, e.g. on unmount.
+    void clear();
+
+    // The engine saw a command address this track; the virtual head is
+    // now over it.
+    void noteHeadPosition(int track)
+    {
+        m_head.store(track, std::memory_order_relaxed);
+    }
+
+    // Tracks currently resident, oldest first; used as residency hints
+    // for the startup snapshot.
+    QList<int> residentTracks() const
+    {
+        QMutexLocker locker(&m_lock);
+        return m_order;
+    }
+
+    quint64 hits() const { return m_hits.load(std::memory_order_relaxed); }
+    quint64 misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+private:
+    void schedulePrefetch(int firstTrack);
+    void prefetch(int firstTrack);
+    void insertLocked(int track, const QByteArray &data);
+    bool fillTrack(int track, QByteArray &data);
+
+    std::atomic<Drive *> m_drive;
+    // Bumped by setDrive() and clear(); in-flight fills compare it
+    // before inserting so stale data never lands in the fresh cache.
+    std::atomic<quint64> m_epoch { 0 };
+    mutable QMutex m_lock;
+
+    // Recycled fill buffers: enough for every resident track plus the
+    // read-ahead burst, so cache churn stops touching the allocator.
+    BufferPool m_pool { Capacity + ReadAhead + 4, fdc::MaxTrackLen };
+    QHash<int, QByteArray> m_tracks;
+    QList<int> m_order;                 // insertion order, oldest first
+    std::atomic<bool> m_prefetching { false };
+    std::atomic<int> m_head { -1 };     // last track addressed, -1 = unknown
+    std::atomic<quint64> m_hits { 0 };
+    std::atomic<quint64> m_misses { 0 };
+};
+
+#endif // TRACKCACHE_H
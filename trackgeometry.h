@@ -0,0 +1,81 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * trackgeometry.h -- compile-time specialized track geometry fast paths
+ */
+
+#ifndef TRACKGEOMETRY_H
+#define TRACKGEOMETRY_H
+
+#include "checksum.h"
+#include "fdcproto.h"
+
+namespace fdc {
+
+/*
+ * The FDC+ ecosystem serves a small fixed set of geometries -- 8 inch
+ * tracks of 32 x 137 byte sectors, minidisk tracks of 16 -- so the
+ * per-sector arithmetic in the hottest loops does not have to consult
+ * runtime variables.  TrackGeometry<N> bakes the track length, sector
+ * count and sector stride in as compile-time constants: after
+ * instantiation every loop bound and offset below is a literal, which
+ * lets the compiler constant-fold, unroll and vectorize without the
+ * per-call length branches of the generic path.
+ *
+ * A drive whose track length matches a known specialization picks up
+ * the corresponding function pointer at mount time (see
+ * trackChecksumFor()); odd images keep the generic runtime-length
+ * path.
+ */
+template <int TrackLenT>
+struct TrackGeometry
+{
+    static_assert(TrackLenT % SectorLen == 0,
+                  "a track is a whole number of sectors");
+
+    static constexpr int TrackLen = TrackLenT;
+    static constexpr int Sectors = TrackLenT / SectorLen;
+
+    // Byte offset of a sector; the multiplier is a literal, so this is
+    // strength-reduced, never a runtime multiply-and-check.
+    static constexpr int sectorOffset(int sector)
+    {
+        return sector * SectorLen;
+    }
+
+    // Additive checksum of a whole track, accumulated per sector in
+    // transmission order units.
+    static quint16 trackChecksum(const quint8 *track)
+    {
+        quint16 sum = 0;
+
+        for (int s = 0; s < Sectors; s++)
+            sum += checksumFixed<SectorLen>(track + sectorOffset(s));
+
+        return sum;
+    }
+};
+
+// Whole-track checksum specialized for a geometry, selected once at
+// mount time.
+using TrackChecksumFn = quint16 (*)(const quint8 *);
+
+// The specialization matching a track length, or null for geometries
+// outside the known set (the caller falls back to fdc::checksum()).
+// Generic hard disk images reuse the 8 inch track and hit the fast
+// path too.
+inline TrackChecksumFn trackChecksumFor(int trackLen)
+{
+    switch (trackLen) {
+    case TrackLen8:
+        return &TrackGeometry<TrackLen8>::trackChecksum;
+    case TrackLenMini:
+        return &TrackGeometry<TrackLenMini>::trackChecksum;
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace fdc
+
+#endif // TRACKGEOMETRY_H
@@ -0,0 +1,115 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * writejournal.cpp -- write-behind journal for WRIT commands
+ */
+
+#include "writejournal.h"
+#include "drive.h"
+
+#include <algorithm>
+
+WriteJournal::WriteJournal(QObject *parent)
+    : QThread(parent)
+{
+}
+
+WriteJournal::~WriteJournal()
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_stop = true;
+        m_notEmpty.wakeAll();
+    }
+
+    wait();
+}
+
+void WriteJournal::append(Drive *drive, int track, const QByteArray &data)
+{
+    QMutexLocker locker(&m_lock);
+
+    while (m_entries.size() >= MaxDepth && !m_stop)
+        m_notFull.wait(&m_lock);
+
+    // A newer write to the same track supersedes the journaled one.
+    for (Entry &entry : m_entries) {
+        if (entry.drive == drive && entry.track == track) {
+            entry.data = data;
+            return;
+        }
+    }
+
+    m_entries.append({ drive, track, data });
+    m_notEmpty.wakeOne();
+}
+
+void WriteJournal::flushDrive(Drive *drive)
+{
+    QMutexLocker locker(&m_lock);
+
+    while (pendingFor(drive)) {
+        m_notEmpty.wakeOne();
+        m_drained.wait(&m_lock);
+    }
+}
+
+int WriteJournal::depth() const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_entries.size() + m_inFlight.size();
+}
+
+bool WriteJournal::pendingFor(Drive *drive) const
+{
+    for (const Entry &entry : m_entries) {
+        if (entry.drive == drive)
+            return true;
+    }
+    for (const Entry &entry : m_inFlight) {
+        if (entry.drive == drive)
+            return true;
+    }
+
+    return false;
+}
+
+void WriteJournal::run()
+{
+    for (;;) {
+        {
+            QMutexLocker locker(&m_lock);
+
+            while (m_entries.isEmpty() && !m_stop)
+                m_notEmpty.wait(&m_lock);
+
+            if (m_entries.isEmpty() && m_stop)
+                return;
+
+            // Take the whole batch and order it so same-drive,
+            // adjacent-track writes commit as one sequential run.
+            m_inFlight = std::move(m_entries);
+            m_entries.clear();
+            std::stable_sort(m_inFlight.begin(), m_inFlight.end(),
+                             [](const Entry &a, const Entry &b) {
+                                 if (a.drive != b.drive)
+                                     return a.drive < b.drive;
+                                 return a.track < b.track;
+                             });
+            m_notFull.wakeAll();
+        }
+
+        for (const Entry &entry : m_inFlight) {
+            entry.drive->writeTrack(
+                entry.track,
+                reinterpret_cast<const quint8 *>(entry.data.constData()));
+        }
+
+        {
+            QMutexLocker locker(&m_lock);
+            m_inFlight.clear();
+            m_drained.wakeAll();
+        }
+    }
+}
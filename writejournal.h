@@ -0,0 +1,70 @@
+/*
+ * fdc-sds-qt6 -- FDC+ Serial Drive Server for Qt 6
+ *
+ * writejournal.h -- write-behind journal for WRIT commands
+ */
+
+#ifndef WRITEJOURNAL_H
+#define WRITEJOURNAL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+class Drive;
+
+/*
+ * Decouples WRIT acknowledgement from storage latency.  The protocol
+ * engine appends the captured track and acknowledges immediately; this
+ * thread drains the journal in batches, sorted so adjacent tracks of
+ * the same drive commit as one sequential run, which is what SD cards
+ * and spinning disks want to see.
+ *
+ * Depth is bounded: append() blocks once MaxDepth tracks are pending,
+ * so a storage stall turns into backpressure rather than unbounded
+ * memory growth.  flushDrive() blocks until every journaled track of a
+ * drive is on disk and is called before unmount or a drive change.
+ */
+class WriteJournal : public QThread
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MaxDepth = 32;
+
+    explicit WriteJournal(QObject *parent = nullptr);
+    ~WriteJournal();
+
+    // Capture a track for deferred commit.  Blocks while the journal is
+    // full.  The data is copied.
+    void append(Drive *drive, int track, const QByteArray &data);
+
+    // Wait until no journaled or in-flight track remains for the drive.
+    void flushDrive(Drive *drive);
+
+    int depth() const;
+
+protected:
+    void run() override;
+
+private:
+    struct Entry {
+        Drive *drive;
+        int track;
+        QByteArray data;
+    };
+
+    bool pendingFor(Drive *drive) const;
+
+    mutable QMutex m_lock;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QWaitCondition m_drained;
+    QList<Entry> m_entries;
+    QList<Entry> m_inFlight;
+    bool m_stop = false;
+};
+
+#endif // WRITEJOURNAL_H